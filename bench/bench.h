@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace bench
+{
+    /**
+    Runs a function repeatedly and returns its average wall-clock time.
+
+    @param[in] repetitions The number of timed runs, after one untimed warm-up run.
+    @param[in] function The function to time.
+    @return The average time of one run in milliseconds.
+    */
+    template <typename F>
+    double_t average_ms(const int32_t repetitions, F&& function)
+    {
+        function();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int32_t r = 0; r < repetitions; r++)
+        {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double_t, std::milli>(end - start).count() / repetitions;
+    }
+}
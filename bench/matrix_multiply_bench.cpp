@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "encryptedmatrix.h"
+#include "fhebuilder.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace fhe;
+
+namespace
+{
+    std::vector<std::vector<double_t>> random_matrix(const size_t dimension, std::mt19937_64& engine)
+    {
+        std::uniform_real_distribution<double_t> distribution(-1.0, 1.0);
+        std::vector<std::vector<double_t>> matrix(dimension, std::vector<double_t>(dimension));
+
+        for (std::vector<double_t>& row : matrix)
+        {
+            for (double_t& entry : row)
+            {
+                entry = distribution(engine);
+            }
+        }
+
+        return matrix;
+    }
+
+    std::vector<std::vector<double_t>> multiply(const std::vector<std::vector<double_t>>& a, const std::vector<std::vector<double_t>>& b)
+    {
+        const size_t dimension = a.size();
+        std::vector<std::vector<double_t>> product(dimension, std::vector<double_t>(dimension, 0.0));
+
+        for (size_t i = 0; i < dimension; i++)
+        {
+            for (size_t k = 0; k < dimension; k++)
+            {
+                for (size_t j = 0; j < dimension; j++)
+                {
+                    product[i][j] += a[i][k] * b[k][j];
+                }
+            }
+        }
+
+        return product;
+    }
+}
+
+// Times EncryptedMatrix::multiply for d = 16, 32 and 64 at N = 8192, 16384 and 32768 (CKKS) and checks the
+// decrypted product against a plaintext matrix multiplication. Depending on how d * d compares with the row
+// size, the row shifts take the full-row path (d * d = row), the repeated path (2 * d * d <= row) or the
+// non-cyclic path (d * d < row < 2 * d * d).
+int main()
+{
+    const std::vector<size_t> dimensions = { 16, 32, 64 };
+    const int32_t repetitions = 3;
+    const double_t tolerance = 1e-2;
+    std::mt19937_64 engine(1);
+    bool passed = true;
+
+    std::printf("%8s %4s %10s %12s %12s %8s\n", "N", "d", "path", "ms/product", "max error", "levels");
+
+    for (const size_t poly_modulus_degree : { size_t(8192), size_t(16384), size_t(32768) })
+    {
+        const size_t row_size = poly_modulus_degree / 2;
+
+        rotation_workload_t workload;
+        for (const size_t dimension : dimensions)
+        {
+            if (dimension * dimension <= row_size)
+            {
+                workload.matrix_products.push_back(dimension);
+            }
+        }
+
+        FHEBuilder builder;
+        builder.galois_keys(workload);
+
+        // A product consumes three levels, which N = 8192 only fits with 30-bit primes.
+        FHE& fhe = poly_modulus_degree == 8192 ?
+            builder.build_real_complex_scheme(real_complex_scheme_t::ckks, poly_modulus_degree, std::pow(2.0, 30), { 50, 30, 30, 30, 50 }) :
+            builder.build_real_complex_scheme(real_complex_scheme_t::ckks, poly_modulus_degree, std::pow(2.0, 40));
+
+        for (const size_t dimension : workload.matrix_products)
+        {
+            const size_t area = dimension * dimension;
+            const char* path = area == row_size ? "full-row" : (2 * area <= row_size ? "repeated" : "non-cyclic");
+
+            const std::vector<std::vector<double_t>> a = random_matrix(dimension, engine);
+            const std::vector<std::vector<double_t>> b = random_matrix(dimension, engine);
+            const std::vector<std::vector<double_t>> expected = multiply(a, b);
+
+            const EncryptedMatrix encrypted_a = EncryptedMatrix::encrypt(fhe, a);
+            const EncryptedMatrix encrypted_b = EncryptedMatrix::encrypt(fhe, b);
+
+            EncryptedMatrix product(fhe);
+            const double_t milliseconds = bench::average_ms(repetitions, [&]
+            {
+                encrypted_a.multiply(encrypted_b, product);
+            });
+
+            const std::vector<std::vector<double_t>> decrypted = product.decrypt<double_t>();
+
+            double_t max_error = 0.0;
+            for (size_t i = 0; i < dimension; i++)
+            {
+                for (size_t j = 0; j < dimension; j++)
+                {
+                    max_error = std::max(max_error, std::fabs(decrypted[i][j] - expected[i][j]));
+                }
+            }
+
+            passed = passed && max_error <= tolerance;
+
+            const size_t levels = encrypted_a.ciphertext().coeff_modulus_size() - product.ciphertext().coeff_modulus_size();
+            std::printf("%8zu %4zu %10s %12.3f %12.3e %8zu\n", poly_modulus_degree, dimension, path, milliseconds, max_error, levels);
+        }
+    }
+
+    if (!passed)
+    {
+        std::printf("FAILED: an error exceeds %.0e\n", tolerance);
+    }
+
+    return passed ? 0 : 1;
+}
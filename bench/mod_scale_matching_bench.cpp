@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "fhebuilder.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace fhe;
+
+// Compares the cost per dropped level of CKKS level alignment:
+// - per-level: encode 1, multiply and rescale once for every level, as mod_scale_matching used to do;
+// - mod_scale_matching: one modulus switch, one multiplication and one rescale.
+// The aligned ciphertexts are decrypted and checked against the plaintext values.
+int main()
+{
+    const size_t poly_modulus_degree = 16384;
+    const int32_t repetitions = 10;
+    const double_t tolerance = 1e-4;
+    bool passed = true;
+
+    FHE& fhe = FHEBuilder().galois_keys(false).build_real_complex_scheme(real_complex_scheme_t::ckks, poly_modulus_degree, std::pow(2.0, 40));
+
+    const size_t slot_count = fhe.slot_count();
+    const std::vector<double_t> ones(slot_count, 1.0);
+
+    std::vector<double_t> values(slot_count);
+    for (size_t i = 0; i < slot_count; i++)
+    {
+        values[i] = 0.9 + 0.1 * std::sin(static_cast<double_t>(i));
+    }
+
+    const seal::Ciphertext fresh = fhe.encrypt(fhe.encode(values));
+    seal::Ciphertext deep = fresh;
+    std::vector<double_t> deep_values = values;
+
+    std::printf("N = %zu\n", poly_modulus_degree);
+    std::printf("%8s %22s %22s %12s\n", "levels", "per-level (ms/level)", "matching (ms/level)", "max error");
+
+    for (size_t levels = 1; deep.coeff_modulus_size() > 1; levels++)
+    {
+        // Squaring drops one level and moves the scale away from the fresh ciphertext's.
+        deep = fhe.multiply(deep, deep);
+        for (double_t& value : deep_values)
+        {
+            value *= value;
+        }
+
+        const double_t per_level = bench::average_ms(repetitions, [&]
+        {
+            seal::Ciphertext lowered = fresh;
+            seal::Plaintext one;
+            while (lowered.coeff_modulus_size() > deep.coeff_modulus_size())
+            {
+                fhe.encode(ones, one, lowered.parms_id(), lowered.scale());
+                fhe.multiply_inplace(lowered, one);
+            }
+        });
+
+        seal::Ciphertext aligned_fresh;
+        seal::Ciphertext aligned_deep;
+        const double_t matching = bench::average_ms(repetitions, [&]
+        {
+            fhe.mod_scale_matching(fresh, deep, aligned_fresh, aligned_deep);
+        });
+
+        // The sum only decrypts correctly if both level and scale were matched.
+        const std::vector<double_t> sum = fhe.decode<double_t>(fhe.decrypt(fhe.add(aligned_fresh, aligned_deep)));
+
+        double_t max_error = 0.0;
+        for (size_t i = 0; i < slot_count; i++)
+        {
+            max_error = std::max(max_error, std::fabs(sum[i] - (values[i] + deep_values[i])));
+        }
+
+        passed = passed && max_error <= tolerance;
+        std::printf("%8zu %22.3f %22.3f %12.3e\n", levels, per_level / levels, matching / levels, max_error);
+    }
+
+    if (!passed)
+    {
+        std::printf("FAILED: an error exceeds %.0e\n", tolerance);
+    }
+
+    return passed ? 0 : 1;
+}
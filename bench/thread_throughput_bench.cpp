@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "fhebuilder.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace fhe;
+
+// Measures the throughput of encrypt_batch and decrypt_decode_batch (CKKS, N = 8192) on 1 to 64 threads of
+// the FHE instance's thread pool, and checks that the round trip returns the input rows.
+int main()
+{
+    const size_t poly_modulus_degree = 8192;
+    const size_t row_count = 256;
+    const int32_t repetitions = 3;
+    const double_t tolerance = 1e-4;
+
+    FHE& fhe = FHEBuilder().galois_keys(false).build_real_complex_scheme(real_complex_scheme_t::ckks, poly_modulus_degree, std::pow(2.0, 40));
+
+    std::vector<std::vector<double_t>> rows(row_count, std::vector<double_t>(fhe.slot_count()));
+    for (size_t r = 0; r < row_count; r++)
+    {
+        for (size_t i = 0; i < rows[r].size(); i++)
+        {
+            rows[r][i] = std::sin(static_cast<double_t>(r * rows[r].size() + i));
+        }
+    }
+
+    std::printf("%zu rows, %u hardware threads\n", row_count, std::thread::hardware_concurrency());
+    std::printf("%8s %20s %20s %12s\n", "threads", "encrypt (rows/s)", "decrypt (rows/s)", "max error");
+
+    bool passed = true;
+
+    for (const size_t thread_count : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        fhe.thread_count(thread_count);
+
+        std::vector<seal::Ciphertext> ciphertexts;
+        const double_t encrypt_ms = bench::average_ms(repetitions, [&]
+        {
+            fhe.encrypt_batch(rows, ciphertexts);
+        });
+
+        std::vector<std::vector<double_t>> decrypted;
+        const double_t decrypt_ms = bench::average_ms(repetitions, [&]
+        {
+            fhe.decrypt_decode_batch(ciphertexts, decrypted);
+        });
+
+        double_t max_error = 0.0;
+        for (size_t r = 0; r < row_count; r++)
+        {
+            for (size_t i = 0; i < rows[r].size(); i++)
+            {
+                max_error = std::max(max_error, std::fabs(decrypted[r][i] - rows[r][i]));
+            }
+        }
+
+        passed = passed && max_error <= tolerance;
+        std::printf("%8zu %20.1f %20.1f %12.3e\n", thread_count, row_count * 1000.0 / encrypt_ms, row_count * 1000.0 / decrypt_ms, max_error);
+    }
+
+    if (!passed)
+    {
+        std::printf("FAILED: an error exceeds %.0e\n", tolerance);
+    }
+
+    return passed ? 0 : 1;
+}
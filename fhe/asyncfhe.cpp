@@ -0,0 +1,105 @@
+#include "asyncfhe.h"
+#include <stdexcept>
+
+namespace fhe
+{
+    AsyncFHE::AsyncFHE(const FHE& fhe, const size_t thread_count) :
+        fhe_(&fhe),
+        executor_(thread_count) {
+    }
+
+    const FHE& AsyncFHE::fhe() const
+    {
+        return *fhe_;
+    }
+
+    Executor& AsyncFHE::executor()
+    {
+        return executor_;
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::encrypt(const Future<seal::Plaintext>& plaintext)
+    {
+        return then([](const FHE& fhe, const seal::Plaintext& plain) { return fhe.encrypt(plain); }, plaintext);
+    }
+
+    Future<seal::Plaintext> AsyncFHE::decrypt(const Future<seal::Ciphertext>& ciphertext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& cipher) { return fhe.decrypt(cipher); }, ciphertext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::add(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Ciphertext& rhs) { return fhe.add(lhs, rhs); }, ciphertext1, ciphertext2);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::add(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Plaintext& rhs) { return fhe.add(lhs, rhs); }, ciphertext, plaintext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::sub(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Ciphertext& rhs) { return fhe.sub(lhs, rhs); }, ciphertext1, ciphertext2);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::sub(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Plaintext& rhs) { return fhe.sub(lhs, rhs); }, ciphertext, plaintext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::multiply(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Ciphertext& rhs) { return fhe.multiply(lhs, rhs); }, ciphertext1, ciphertext2);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::multiply(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& lhs, const seal::Plaintext& rhs) { return fhe.multiply(lhs, rhs); }, ciphertext, plaintext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::square(const Future<seal::Ciphertext>& ciphertext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& cipher) { return fhe.square(cipher); }, ciphertext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::negate(const Future<seal::Ciphertext>& ciphertext)
+    {
+        return then([](const FHE& fhe, const seal::Ciphertext& cipher) { return fhe.negate(cipher); }, ciphertext);
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::add_many(const std::vector<Future<seal::Ciphertext>>& ciphertexts)
+    {
+        if (ciphertexts.empty())
+        {
+            throw std::invalid_argument("The ciphertext vector must not be empty.");
+        }
+
+        // Pairs are added round by round; an odd one out is carried to the next round.
+        std::vector<Future<seal::Ciphertext>> round = ciphertexts;
+        while (round.size() > 1)
+        {
+            std::vector<Future<seal::Ciphertext>> next;
+            next.reserve((round.size() + 1) / 2);
+
+            for (size_t i = 0; i + 1 < round.size(); i += 2)
+            {
+                next.push_back(add(round[i], round[i + 1]));
+            }
+
+            if (round.size() % 2 == 1)
+            {
+                next.push_back(round.back());
+            }
+
+            round = std::move(next);
+        }
+
+        return round.front();
+    }
+
+    Future<seal::Ciphertext> AsyncFHE::rotate(const Future<seal::Ciphertext>& ciphertext, const int32_t step)
+    {
+        return then([step](const FHE& fhe, const seal::Ciphertext& cipher) { return fhe.rotate(cipher, step); }, ciphertext);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "seal/seal.h"
+#include "executor.h"
+#include "fhe.h"
+#include <complex>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class AsyncFHE
+    Non-blocking versions of the FHE operations, scheduled on a work-stealing executor.
+
+    @details
+    Every operation takes its operands as futures, returns a future for its result immediately, and starts
+    as soon as all of its operands are ready, so independent branches of a circuit, such as two rotations
+    feeding one addition, run concurrently without the caller managing threads:
+
+    @code
+    AsyncFHE async(fhe, 0);
+    auto x = async.value(ciphertext);
+    auto y = async.add(async.rotate(x, 1), async.rotate(x, 2));
+    const seal::Ciphertext& result = y.get();
+    @endcode
+
+    The operations call the const member functions of the wrapped FHE instance, which are safe to call
+    concurrently; their internal parallel loops still run on the instance's own thread pool. An exception
+    thrown by an operation is carried by its future and by every future that depends on it, and is thrown
+    by `get`. The FHE instance must outlive this object, whose destructor waits for all queued operations.
+    */
+    class AsyncFHE
+    {
+    public:
+        /**
+        Creates the asynchronous layer and starts its executor.
+
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] thread_count The number of executor threads. If 0, the number of hardware threads is used.
+        */
+        AsyncFHE(const FHE& fhe, const size_t thread_count);
+
+        /**
+        Retrieves the wrapped FHE instance.
+        */
+        const FHE& fhe() const;
+
+        /**
+        Retrieves the executor that runs the operations.
+        */
+        Executor& executor();
+
+        /**
+        Wraps an existing value in a ready future, to be used as an operand.
+
+        @param[in] value The value.
+        @return A future that is already ready.
+        */
+        template <typename T>
+        Future<T> value(T value) const
+        {
+            return Future<T>::ready_value(std::move(value));
+        }
+
+        /**
+        Queues `function(fhe(), inputs.get()...)` to run once every input is ready.
+
+        @details
+        Covers every FHE operation without a dedicated asynchronous version.
+
+        @param[in] function The operation. It receives the FHE instance and the results of the inputs as const references.
+        @param[in] inputs The futures whose results the operation reads.
+        @return A future for the result of the operation.
+        */
+        template <typename F, typename... Args>
+        auto then(F function, const Future<Args>&... inputs)
+        {
+            const FHE* fhe = fhe_;
+            return executor_.then([fhe, function](const Args&... values) { return function(*fhe, values...); }, inputs...);
+        }
+
+        /**
+        Encodes a vector of values into a plaintext polynomial.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] values The values to encode.
+        @return A future for the plaintext.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >Future<seal::Plaintext> encode(const Future<std::vector<T>>& values)
+        {
+            return then([](const FHE& fhe, const std::vector<T>& vector) { return fhe.encode(vector); }, values);
+        }
+
+        /**
+        Decodes a plaintext polynomial into a vector of values.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] plaintext The plaintext to decode.
+        @return A future for the values.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >Future<std::vector<T>> decode(const Future<seal::Plaintext>& plaintext)
+        {
+            return then([](const FHE& fhe, const seal::Plaintext& plain) { return fhe.decode<T>(plain); }, plaintext);
+        }
+
+        Future<seal::Ciphertext> encrypt(const Future<seal::Plaintext>& plaintext);
+
+        Future<seal::Plaintext> decrypt(const Future<seal::Ciphertext>& ciphertext);
+
+        // Arithmetic operations
+        Future<seal::Ciphertext> add(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2);
+        Future<seal::Ciphertext> add(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext);
+        Future<seal::Ciphertext> sub(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2);
+        Future<seal::Ciphertext> sub(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext);
+        Future<seal::Ciphertext> multiply(const Future<seal::Ciphertext>& ciphertext1, const Future<seal::Ciphertext>& ciphertext2);
+        Future<seal::Ciphertext> multiply(const Future<seal::Ciphertext>& ciphertext, const Future<seal::Plaintext>& plaintext);
+        Future<seal::Ciphertext> square(const Future<seal::Ciphertext>& ciphertext);
+        Future<seal::Ciphertext> negate(const Future<seal::Ciphertext>& ciphertext);
+
+        /**
+        Adds many ciphertexts in a balanced tree of asynchronous additions.
+
+        @details
+        Each addition starts as soon as its two operands are ready, so the sum of `n` ciphertexts finishes
+        after about `log2(n)` rounds once all of them are available, and the early rounds overlap with
+        whatever is still computing the later operands.
+
+        @param[in] ciphertexts The ciphertexts to add. Must not be empty.
+        @return A future for the sum.
+
+        @throws std::invalid_argument If `ciphertexts` is empty.
+        */
+        Future<seal::Ciphertext> add_many(const std::vector<Future<seal::Ciphertext>>& ciphertexts);
+
+        /**
+        Rotates the slots of a ciphertext.
+
+        @param[in] ciphertext The ciphertext to rotate.
+        @param[in] step The rotation step, as for `FHE::rotate`.
+        @return A future for the rotated ciphertext.
+        */
+        Future<seal::Ciphertext> rotate(const Future<seal::Ciphertext>& ciphertext, const int32_t step);
+
+    private:
+        const FHE* fhe_;
+
+        Executor executor_;
+    };
+}
@@ -0,0 +1,330 @@
+#include "ciphertextbatch.h"
+#include "seal/util/polyarithsmallmod.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe
+{
+    CiphertextBatch::CiphertextBatch(const FHE& fhe) :
+        fhe_(&fhe),
+        parms_id_(seal::parms_id_zero),
+        poly_modulus_degree_(0),
+        size_(0),
+        count_(0),
+        scale_(1.0),
+        is_ntt_form_(false),
+        correction_factor_(1) {
+    }
+
+    CiphertextBatch::CiphertextBatch(const FHE& fhe, const std::vector<seal::Ciphertext>& ciphertexts) :
+        CiphertextBatch(fhe) {
+
+        if (ciphertexts.empty())
+        {
+            throw std::invalid_argument("The batch must contain at least one ciphertext.");
+        }
+
+        const seal::Ciphertext& first = ciphertexts.front();
+
+        parms_id_ = first.parms_id();
+        coeff_modulus_ = fhe_->coeff_modulus(parms_id_);
+        poly_modulus_degree_ = first.poly_modulus_degree();
+        size_ = first.size();
+        count_ = ciphertexts.size();
+        scale_ = first.scale();
+        is_ntt_form_ = first.is_ntt_form();
+        correction_factor_ = first.correction_factor();
+
+        if (!std::all_of(ciphertexts.begin(), ciphertexts.end(), [this](const seal::Ciphertext& ciphertext) { return matches(ciphertext); }))
+        {
+            throw std::invalid_argument("The ciphertexts must share their level, size, scale, NTT form and correction factor.");
+        }
+
+        data_.resize(coeff_modulus_.size() * count_ * size_ * poly_modulus_degree_);
+
+        fhe_->parallel_for(count_, [&](size_t i)
+        {
+            set_ciphertext(i, ciphertexts[i]);
+        });
+    }
+
+    size_t CiphertextBatch::count() const
+    {
+        return count_;
+    }
+
+    const seal::parms_id_type& CiphertextBatch::parms_id() const
+    {
+        return parms_id_;
+    }
+
+    double_t CiphertextBatch::scale() const
+    {
+        return scale_;
+    }
+
+    void CiphertextBatch::ciphertext(const size_t index, seal::Ciphertext& destination) const
+    {
+        if (index >= count_)
+        {
+            throw std::invalid_argument("The ciphertext index is out of range.");
+        }
+
+        // A ciphertext at another level cannot be resized without the context, so it is swapped for a buffer at this level.
+        if (destination.parms_id() != parms_id_)
+        {
+            fhe_->release(std::move(destination));
+            destination = fhe_->acquire_ciphertext(parms_id_);
+        }
+
+        destination.resize(size_);
+
+        const size_t degree = poly_modulus_degree_;
+        for (size_t j = 0; j < coeff_modulus_.size(); j++)
+        {
+            for (size_t k = 0; k < size_; k++)
+            {
+                const std::uint64_t* source = data_.data() + ((j * count_ + index) * size_ + k) * degree;
+                std::copy_n(source, degree, destination.data(k) + j * degree);
+            }
+        }
+
+        destination.scale() = scale_;
+        destination.is_ntt_form() = is_ntt_form_;
+        destination.correction_factor() = correction_factor_;
+    }
+
+    seal::Ciphertext CiphertextBatch::ciphertext(const size_t index) const
+    {
+        seal::Ciphertext destination;
+        ciphertext(index, destination);
+        return destination;
+    }
+
+    void CiphertextBatch::set_ciphertext(const size_t index, const seal::Ciphertext& ciphertext)
+    {
+        if (index >= count_)
+        {
+            throw std::invalid_argument("The ciphertext index is out of range.");
+        }
+
+        if (!matches(ciphertext))
+        {
+            throw std::invalid_argument("The ciphertext does not match the level, size, scale, NTT form or correction factor of the batch.");
+        }
+
+        const size_t degree = poly_modulus_degree_;
+        for (size_t j = 0; j < coeff_modulus_.size(); j++)
+        {
+            for (size_t k = 0; k < size_; k++)
+            {
+                std::uint64_t* destination = data_.data() + ((j * count_ + index) * size_ + k) * degree;
+                std::copy_n(ciphertext.data(k) + j * degree, degree, destination);
+            }
+        }
+    }
+
+    void CiphertextBatch::ciphertexts(std::vector<seal::Ciphertext>& destination) const
+    {
+        destination.resize(count_);
+
+        fhe_->parallel_for(count_, [&](size_t i)
+        {
+            ciphertext(i, destination[i]);
+        });
+    }
+
+    std::vector<seal::Ciphertext> CiphertextBatch::ciphertexts() const
+    {
+        std::vector<seal::Ciphertext> destination;
+        ciphertexts(destination);
+        return destination;
+    }
+
+    void CiphertextBatch::add(const CiphertextBatch& other, CiphertextBatch& destination) const
+    {
+        verify_compatible(other);
+        prepare_destination(destination);
+
+        const std::uint64_t* operand1 = data_.data();
+        const std::uint64_t* operand2 = other.data_.data();
+        std::uint64_t* result = destination.data_.data();
+
+        for_each_run([&](size_t prime, size_t offset, size_t length)
+        {
+            seal::util::add_poly_coeffmod(operand1 + offset, operand2 + offset, length, coeff_modulus_[prime], result + offset);
+        });
+    }
+
+    CiphertextBatch CiphertextBatch::add(const CiphertextBatch& other) const
+    {
+        CiphertextBatch destination(*fhe_);
+        add(other, destination);
+        return destination;
+    }
+
+    void CiphertextBatch::add_inplace(const CiphertextBatch& other)
+    {
+        add(other, *this);
+    }
+
+    void CiphertextBatch::sub(const CiphertextBatch& other, CiphertextBatch& destination) const
+    {
+        verify_compatible(other);
+        prepare_destination(destination);
+
+        const std::uint64_t* operand1 = data_.data();
+        const std::uint64_t* operand2 = other.data_.data();
+        std::uint64_t* result = destination.data_.data();
+
+        for_each_run([&](size_t prime, size_t offset, size_t length)
+        {
+            seal::util::sub_poly_coeffmod(operand1 + offset, operand2 + offset, length, coeff_modulus_[prime], result + offset);
+        });
+    }
+
+    CiphertextBatch CiphertextBatch::sub(const CiphertextBatch& other) const
+    {
+        CiphertextBatch destination(*fhe_);
+        sub(other, destination);
+        return destination;
+    }
+
+    void CiphertextBatch::sub_inplace(const CiphertextBatch& other)
+    {
+        sub(other, *this);
+    }
+
+    void CiphertextBatch::negate(CiphertextBatch& destination) const
+    {
+        prepare_destination(destination);
+
+        const std::uint64_t* operand = data_.data();
+        std::uint64_t* result = destination.data_.data();
+
+        for_each_run([&](size_t prime, size_t offset, size_t length)
+        {
+            seal::util::negate_poly_coeffmod(operand + offset, length, coeff_modulus_[prime], result + offset);
+        });
+    }
+
+    CiphertextBatch CiphertextBatch::negate() const
+    {
+        CiphertextBatch destination(*fhe_);
+        negate(destination);
+        return destination;
+    }
+
+    void CiphertextBatch::negate_inplace()
+    {
+        negate(*this);
+    }
+
+    void CiphertextBatch::multiply(const seal::Plaintext& plaintext, CiphertextBatch& destination) const
+    {
+        if (!is_ntt_form_)
+        {
+            throw std::invalid_argument("This function is only supported for ciphertexts in NTT form (CKKS and BGV schemes).");
+        }
+
+        if (!plaintext.is_ntt_form() || plaintext.parms_id() != parms_id_)
+        {
+            throw std::invalid_argument("The plaintext must be in NTT form at the level of the batch.");
+        }
+
+        const double_t scale = scale_ * plaintext.scale();
+        prepare_destination(destination);
+
+        const size_t degree = poly_modulus_degree_;
+        const std::uint64_t* operand = data_.data();
+        const std::uint64_t* plain = plaintext.data();
+        std::uint64_t* result = destination.data_.data();
+
+        // Every polynomial of a run is multiplied by the plaintext's residues under the run's prime.
+        for_each_run([&](size_t prime, size_t offset, size_t length)
+        {
+            for (size_t polynomial = offset; polynomial < offset + length; polynomial += degree)
+            {
+                seal::util::dyadic_product_coeffmod(operand + polynomial, plain + prime * degree, degree, coeff_modulus_[prime], result + polynomial);
+            }
+        });
+
+        destination.scale_ = scale;
+    }
+
+    CiphertextBatch CiphertextBatch::multiply(const seal::Plaintext& plaintext) const
+    {
+        CiphertextBatch destination(*fhe_);
+        multiply(plaintext, destination);
+        return destination;
+    }
+
+    void CiphertextBatch::multiply_inplace(const seal::Plaintext& plaintext)
+    {
+        multiply(plaintext, *this);
+    }
+
+    bool CiphertextBatch::matches(const seal::Ciphertext& ciphertext) const
+    {
+        return ciphertext.parms_id() == parms_id_ &&
+            ciphertext.size() == size_ &&
+            ciphertext.scale() == scale_ &&
+            ciphertext.is_ntt_form() == is_ntt_form_ &&
+            ciphertext.correction_factor() == correction_factor_;
+    }
+
+    void CiphertextBatch::verify_compatible(const CiphertextBatch& other) const
+    {
+        if (fhe_ != other.fhe_ ||
+            parms_id_ != other.parms_id_ ||
+            size_ != other.size_ ||
+            count_ != other.count_ ||
+            scale_ != other.scale_ ||
+            is_ntt_form_ != other.is_ntt_form_ ||
+            correction_factor_ != other.correction_factor_)
+        {
+            throw std::invalid_argument("The batches must have the same number of ciphertexts, layout and FHE instance.");
+        }
+    }
+
+    void CiphertextBatch::prepare_destination(CiphertextBatch& destination) const
+    {
+        if (&destination == this)
+        {
+            return;
+        }
+
+        destination.fhe_ = fhe_;
+        destination.parms_id_ = parms_id_;
+        destination.coeff_modulus_ = coeff_modulus_;
+        destination.poly_modulus_degree_ = poly_modulus_degree_;
+        destination.size_ = size_;
+        destination.count_ = count_;
+        destination.scale_ = scale_;
+        destination.is_ntt_form_ = is_ntt_form_;
+        destination.correction_factor_ = correction_factor_;
+        destination.data_.resize(data_.size());
+    }
+
+    void CiphertextBatch::for_each_run(const std::function<void(size_t, size_t, size_t)>& kernel) const
+    {
+        if (count_ == 0)
+        {
+            return;
+        }
+
+        // Each prime's array is cut into as many runs as it takes to give every thread one.
+        const size_t primes = coeff_modulus_.size();
+        const size_t runs = std::min(count_, (fhe_->thread_count() + primes - 1) / primes);
+        const size_t ciphertext_length = size_ * poly_modulus_degree_;
+
+        fhe_->parallel_for(primes * runs, [&](size_t task)
+        {
+            const size_t prime = task / runs;
+            const size_t begin = (task % runs) * count_ / runs;
+            const size_t end = (task % runs + 1) * count_ / runs;
+
+            kernel(prime, (prime * count_ + begin) * ciphertext_length, (end - begin) * ciphertext_length);
+        });
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "seal/seal.h"
+#include "fhe.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class CiphertextBatch
+    Many ciphertexts at the same level, stored in one contiguous block.
+
+    @details
+    The coefficients are grouped by prime of the coefficient modulus: for each prime, the residues of every
+    polynomial of every ciphertext follow each other, so an element-wise kernel streams through one long
+    array per prime with a single modulus instead of visiting each ciphertext's allocation. Addition,
+    subtraction, negation and multiplication by a plaintext in NTT form run directly on the block, split
+    across the FHE instance's threads.
+
+    All ciphertexts share their level, size, scale (CKKS) and correction factor (BGV). SEAL ciphertexts own
+    their storage, so `ciphertext` and `ciphertexts` copy out of the block and `set_ciphertext` copies in;
+    every other operation of the FHE class is applied to these copies.
+
+    Both operands of a binary operation must hold the same number of ciphertexts with the same layout and
+    belong to the same FHE instance, which must outlive the batch.
+    */
+    class CiphertextBatch
+    {
+    public:
+        /**
+        Constructs an empty batch.
+
+        @param[in] fhe The FHE instance used for every operation.
+        */
+        explicit CiphertextBatch(const FHE& fhe);
+
+        /**
+        Constructs a batch by copying ciphertexts into one block.
+
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] ciphertexts The ciphertexts to copy. Must not be empty.
+
+        @throws std::invalid_argument If `ciphertexts` is empty or the ciphertexts differ in level, size, scale, NTT form or correction factor.
+        */
+        CiphertextBatch(const FHE& fhe, const std::vector<seal::Ciphertext>& ciphertexts);
+
+        /**
+        Retrieves the number of ciphertexts.
+        */
+        size_t count() const;
+
+        /**
+        Retrieves the parameters ID of the level of the ciphertexts.
+        */
+        const seal::parms_id_type& parms_id() const;
+
+        /**
+        Retrieves the scale of the ciphertexts.
+        */
+        double_t scale() const;
+
+        /**
+        Copies one ciphertext out of the block.
+
+        @details
+        The destination keeps its allocation when it already has room, e.g. a buffer from `FHE::acquire_ciphertext`.
+
+        @param[in] index The position of the ciphertext.
+        @param[out] destination The ciphertext to store the copy.
+
+        @throws std::invalid_argument If `index` is out of range.
+        */
+        void ciphertext(const size_t index, seal::Ciphertext& destination) const;
+
+        seal::Ciphertext ciphertext(const size_t index) const;
+
+        /**
+        Overwrites one ciphertext of the block.
+
+        @param[in] index The position of the ciphertext.
+        @param[in] ciphertext The ciphertext to copy in.
+
+        @throws std::invalid_argument If `index` is out of range or the ciphertext does not match the layout of the batch.
+        */
+        void set_ciphertext(const size_t index, const seal::Ciphertext& ciphertext);
+
+        /**
+        Copies every ciphertext out of the block, in parallel.
+
+        @param[out] destination The vector to be overwritten with the ciphertexts.
+        */
+        void ciphertexts(std::vector<seal::Ciphertext>& destination) const;
+
+        std::vector<seal::Ciphertext> ciphertexts() const;
+
+        /**
+        Adds two batches, ciphertext by ciphertext.
+
+        @param[in] other The batch to add.
+        @param[out] destination The batch to store the result.
+
+        @throws std::invalid_argument If the batches are not compatible.
+        */
+        void add(const CiphertextBatch& other, CiphertextBatch& destination) const;
+
+        CiphertextBatch add(const CiphertextBatch& other) const;
+
+        void add_inplace(const CiphertextBatch& other);
+
+        /**
+        Subtracts another batch, ciphertext by ciphertext.
+
+        @param[in] other The batch to subtract.
+        @param[out] destination The batch to store the result.
+
+        @throws std::invalid_argument If the batches are not compatible.
+        */
+        void sub(const CiphertextBatch& other, CiphertextBatch& destination) const;
+
+        CiphertextBatch sub(const CiphertextBatch& other) const;
+
+        void sub_inplace(const CiphertextBatch& other);
+
+        /**
+        Negates every ciphertext.
+
+        @param[out] destination The batch to store the result.
+        */
+        void negate(CiphertextBatch& destination) const;
+
+        CiphertextBatch negate() const;
+
+        void negate_inplace();
+
+        /**
+        Multiplies every ciphertext by the same plaintext.
+
+        @details
+        Only ciphertexts in NTT form (CKKS and BGV) are supported, and the plaintext must be in NTT form at
+        the level of the batch, as produced by `FHE::transform_to_ntt`, so the product is a slot-wise
+        multiplication per prime. The products are neither rescaled nor modulus switched, so that several of
+        them can be added first; the CKKS scale becomes the product of both scales. Finish each product with
+        `FHE::finish_multiply_inplace` after copying it out.
+
+        @param[in] plaintext The plaintext in NTT form.
+        @param[out] destination The batch to store the products.
+
+        @throws std::invalid_argument If the ciphertexts are not in NTT form or the plaintext is not in NTT form at the level of the batch.
+        */
+        void multiply(const seal::Plaintext& plaintext, CiphertextBatch& destination) const;
+
+        CiphertextBatch multiply(const seal::Plaintext& plaintext) const;
+
+        void multiply_inplace(const seal::Plaintext& plaintext);
+
+    private:
+        /**
+        Checks that a ciphertext matches the level, size, scale, NTT form and correction factor of the batch.
+        */
+        bool matches(const seal::Ciphertext& ciphertext) const;
+
+        void verify_compatible(const CiphertextBatch& other) const;
+
+        /**
+        Gives the destination the layout of this batch, keeping its block when it already has the right size.
+        */
+        void prepare_destination(CiphertextBatch& destination) const;
+
+        /**
+        Splits the block into runs of whole ciphertexts under a single prime and calls
+        `kernel(prime, offset, length)` for each of them on the FHE instance's threads, where `prime` indexes
+        `coeff_modulus_` and `offset` and `length` count coefficients.
+        */
+        void for_each_run(const std::function<void(size_t, size_t, size_t)>& kernel) const;
+
+        const FHE* fhe_;
+
+        seal::parms_id_type parms_id_;
+
+        std::vector<seal::Modulus> coeff_modulus_;
+
+        size_t poly_modulus_degree_;
+
+        size_t size_;
+
+        size_t count_;
+
+        double_t scale_;
+
+        bool is_ntt_form_;
+
+        std::uint64_t correction_factor_;
+
+        std::vector<std::uint64_t> data_;
+    };
+}
@@ -56,4 +56,22 @@ namespace fhe
         // Perform convolution-based multiplication.
         convolution = 0x2
     };
+
+    /**
+    Enumeration of modulus switching policies applied after BGV and BFV multiplication.
+    */
+    enum class mod_switch_policy_t : std::uint8_t
+    {
+        // Switch to the next modulus after every multiplication.
+        eager = 0x1,
+
+        // Never switch modulus after multiplication.
+        never = 0x2,
+
+        // Switch only while it costs no noise budget, i.e. once the noise has outgrown the larger modulus.
+        noise_budget = 0x3,
+
+        // Switch down to a fixed coefficient modulus size after multiplication.
+        fixed_level = 0x4
+    };
 }
\ No newline at end of file
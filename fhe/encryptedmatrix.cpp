@@ -0,0 +1,159 @@
+#include "encryptedmatrix.h"
+#include <stdexcept>
+
+namespace fhe
+{
+    EncryptedMatrix::EncryptedMatrix(const FHE& fhe) :
+        fhe_(&fhe),
+        dimension_(0) {
+    }
+
+    EncryptedMatrix::EncryptedMatrix(const FHE& fhe, seal::Ciphertext ciphertext, const size_t dimension) :
+        fhe_(&fhe),
+        ciphertext_(std::move(ciphertext)),
+        dimension_(dimension) {
+
+        if (dimension_ < 1 || dimension_ * dimension_ > static_cast<size_t>(fhe_->row_size()))
+        {
+            throw std::invalid_argument("The matrix must be non-empty and fit in one row.");
+        }
+    }
+
+    size_t EncryptedMatrix::dimension() const
+    {
+        return dimension_;
+    }
+
+    const seal::Ciphertext& EncryptedMatrix::ciphertext() const
+    {
+        return ciphertext_;
+    }
+
+    void EncryptedMatrix::add(const EncryptedMatrix& other, EncryptedMatrix& destination) const
+    {
+        destination = *this;
+        destination.add_inplace(other);
+    }
+
+    EncryptedMatrix EncryptedMatrix::add(const EncryptedMatrix& other) const
+    {
+        EncryptedMatrix destination(*fhe_);
+        add(other, destination);
+        return destination;
+    }
+
+    void EncryptedMatrix::add_inplace(const EncryptedMatrix& other)
+    {
+        verify_compatible(other);
+        fhe_->add_inplace(ciphertext_, other.ciphertext_);
+    }
+
+    void EncryptedMatrix::sub(const EncryptedMatrix& other, EncryptedMatrix& destination) const
+    {
+        destination = *this;
+        destination.sub_inplace(other);
+    }
+
+    EncryptedMatrix EncryptedMatrix::sub(const EncryptedMatrix& other) const
+    {
+        EncryptedMatrix destination(*fhe_);
+        sub(other, destination);
+        return destination;
+    }
+
+    void EncryptedMatrix::sub_inplace(const EncryptedMatrix& other)
+    {
+        verify_compatible(other);
+        fhe_->sub_inplace(ciphertext_, other.ciphertext_);
+    }
+
+    void EncryptedMatrix::multiply(const EncryptedMatrix& other, EncryptedMatrix& destination) const
+    {
+        destination = *this;
+        destination.multiply_inplace(other);
+    }
+
+    EncryptedMatrix EncryptedMatrix::multiply(const EncryptedMatrix& other) const
+    {
+        EncryptedMatrix destination(*fhe_);
+        multiply(other, destination);
+        return destination;
+    }
+
+    void EncryptedMatrix::multiply_inplace(const EncryptedMatrix& other)
+    {
+        verify_compatible(other);
+
+        const size_t dimension = dimension_;
+        const int32_t size = fhe_->row_size();
+        const int32_t area = static_cast<int32_t>(dimension * dimension);
+
+        seal::Ciphertext sigma = fhe_->permute(ciphertext_, matrix_transform_source(matrix_transform_t::sigma, dimension));
+        seal::Ciphertext tau = fhe_->permute(other.ciphertext_, matrix_transform_source(matrix_transform_t::tau, dimension));
+
+        // With a copy of tau(B) right behind it, shifting by k rows is a plain rotation by k * d.
+        const bool cyclic = area == size || 2 * area <= size;
+        if (2 * area <= size)
+        {
+            seal::Ciphertext copy(fhe_->memory_pool());
+            fhe_->rotate(tau, -area, copy);
+            fhe_->add_inplace(tau, copy);
+        }
+
+        std::vector<std::vector<int32_t>> column_shifts;
+        std::vector<std::vector<int32_t>> row_shifts;
+
+        for (size_t k = 1; k < dimension; k++)
+        {
+            column_shifts.push_back(matrix_transform_source(matrix_transform_t::column_shift, dimension, k));
+            if (!cyclic)
+            {
+                row_shifts.push_back(matrix_transform_source(matrix_transform_t::row_shift, dimension, k));
+            }
+        }
+
+        std::vector<seal::Ciphertext> lhs = fhe_->permute_many(sigma, column_shifts);
+        std::vector<seal::Ciphertext> rhs;
+
+        if (cyclic)
+        {
+            rhs.resize(dimension - 1);
+            fhe_->parallel_for(rhs.size(), [&](size_t k)
+            {
+                fhe_->rotate(tau, static_cast<int32_t>((k + 1) * dimension), rhs[k]);
+            });
+        }
+        else
+        {
+            rhs = fhe_->permute_many(tau, row_shifts);
+        }
+
+        lhs.insert(lhs.begin(), std::move(sigma));
+        rhs.insert(rhs.begin(), std::move(tau));
+
+        // The column shifts keep sigma(A) zero past the matrix, so the products are zero there as well.
+        const size_t chunks = std::max<size_t>(1, std::min(dimension, fhe_->thread_count()));
+        std::vector<seal::Ciphertext> partial(chunks);
+
+        fhe_->parallel_for(chunks, [&](size_t c)
+        {
+            const size_t begin = c * dimension / chunks;
+            const size_t end = (c + 1) * dimension / chunks;
+
+            fhe_->sum_of_products(
+                std::vector<seal::Ciphertext>(lhs.begin() + begin, lhs.begin() + end),
+                std::vector<seal::Ciphertext>(rhs.begin() + begin, rhs.begin() + end),
+                partial[c]);
+        });
+
+        fhe_->add_many(partial, ciphertext_);
+    }
+
+    void EncryptedMatrix::verify_compatible(const EncryptedMatrix& other) const
+    {
+        if (fhe_ != other.fhe_ || dimension_ != other.dimension_)
+        {
+            throw std::invalid_argument("The matrices must have the same dimension and FHE instance.");
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "seal/seal.h"
+#include "fhe.h"
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class EncryptedMatrix
+    An encrypted square matrix, packed row-major into one ciphertext.
+
+    @details
+    Entry (i, j) of a d x d matrix is stored in slot `i * d + j` of the first row (of the slot vector for CKKS),
+    so `d * d` must not exceed the row size. All other slots are zero, and every operation keeps them zero.
+
+    Matrices are multiplied with the method of Jiang, Kim, Lauter and Song: the operands are first permuted to
+    `sigma(A)(i, j) = A(i, i + j)` and `tau(B)(i, j) = B(i + j, j)`, and the product is then the sum over `k` of
+    the slotwise products of `sigma(A)` shifted by `k` columns and `tau(B)` shifted by `k` rows. The permutations
+    are evaluated with `FHE::permute`, which takes about `2 * sqrt(2d)` rotations for each of `sigma` and `tau`,
+    and the column shifts share one baby rotation, so a product takes about `2d + 4 * sqrt(2d)` rotations and
+    `d` ciphertext multiplications, and consumes three levels.
+
+    Both operands of a binary operation must have the same dimension and belong to the same FHE instance,
+    which must outlive the matrix. The rotation keys are described by `rotation_workload_t::matrix_products`.
+    */
+    class EncryptedMatrix
+    {
+    public:
+        /**
+        Constructs an empty matrix.
+
+        @param[in] fhe The FHE instance used for every operation.
+        */
+        explicit EncryptedMatrix(const FHE& fhe);
+
+        /**
+        Constructs a matrix from an existing ciphertext.
+
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] ciphertext The ciphertext, packed row-major with zero slots past `dimension * dimension`.
+        @param[in] dimension The number of rows and columns.
+
+        @throws std::invalid_argument If the matrix is empty or does not fit in a row.
+        */
+        EncryptedMatrix(const FHE& fhe, seal::Ciphertext ciphertext, const size_t dimension);
+
+        /**
+        Encodes and encrypts a square matrix.
+
+        @tparam T The type of the entries (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] matrix The matrix, as a vector of rows.
+        @return The encrypted matrix.
+
+        @throws std::invalid_argument If the matrix is empty, not square, or does not fit in a row.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >static EncryptedMatrix encrypt(const FHE& fhe, const std::vector<std::vector<T>>& matrix)
+        {
+            const size_t dimension = matrix.size();
+
+            if (std::any_of(matrix.begin(), matrix.end(), [dimension](const std::vector<T>& row) { return row.size() != dimension; }))
+            {
+                throw std::invalid_argument("The matrix must be square.");
+            }
+
+            std::vector<T> values;
+            values.reserve(dimension * dimension);
+
+            for (const std::vector<T>& row : matrix)
+            {
+                values.insert(values.end(), row.begin(), row.end());
+            }
+
+            seal::Plaintext plain(fhe.memory_pool());
+            seal::Ciphertext ciphertext;
+            fhe.encode(values, plain);
+            fhe.encrypt(plain, ciphertext);
+
+            return EncryptedMatrix(fhe, std::move(ciphertext), dimension);
+        }
+
+        /**
+        Decrypts and decodes the matrix.
+
+        @tparam T The type of the entries (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[out] destination The matrix to be overwritten with the decrypted rows.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decrypt(std::vector<std::vector<T>>& destination) const
+        {
+            seal::Plaintext plain(fhe_->memory_pool());
+            std::vector<T> values;
+            fhe_->decrypt(ciphertext_, plain);
+            fhe_->decode(plain, values);
+
+            destination.resize(dimension_);
+            for (size_t i = 0; i < dimension_; i++)
+            {
+                destination[i].assign(values.begin() + i * dimension_, values.begin() + (i + 1) * dimension_);
+            }
+        }
+
+        /**
+        Decrypts and decodes the matrix and returns its rows.
+
+        @tparam T The type of the entries (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @return The decrypted rows.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >std::vector<std::vector<T>> decrypt() const
+        {
+            std::vector<std::vector<T>> destination;
+            decrypt(destination);
+            return destination;
+        }
+
+        /**
+        Retrieves the number of rows and columns.
+        */
+        size_t dimension() const;
+
+        /**
+        Retrieves the ciphertext.
+        */
+        const seal::Ciphertext& ciphertext() const;
+
+        /**
+        Adds two matrices.
+
+        @param[in] other The matrix to add.
+        @param[out] destination The matrix to store the result.
+
+        @throws std::invalid_argument If the matrices are not compatible.
+        */
+        void add(const EncryptedMatrix& other, EncryptedMatrix& destination) const;
+
+        EncryptedMatrix add(const EncryptedMatrix& other) const;
+
+        void add_inplace(const EncryptedMatrix& other);
+
+        /**
+        Subtracts another matrix.
+
+        @param[in] other The matrix to subtract.
+        @param[out] destination The matrix to store the result.
+
+        @throws std::invalid_argument If the matrices are not compatible.
+        */
+        void sub(const EncryptedMatrix& other, EncryptedMatrix& destination) const;
+
+        EncryptedMatrix sub(const EncryptedMatrix& other) const;
+
+        void sub_inplace(const EncryptedMatrix& other);
+
+        /**
+        Multiplies two matrices (this matrix on the left).
+
+        @details
+        The `d` slotwise products are computed in parallel chunks with `FHE::sum_of_products`, which
+        relinearizes once per chunk.
+
+        @param[in] other The matrix to multiply by, on the right.
+        @param[out] destination The matrix to store the product.
+
+        @throws std::invalid_argument If the matrices are not compatible.
+        */
+        void multiply(const EncryptedMatrix& other, EncryptedMatrix& destination) const;
+
+        EncryptedMatrix multiply(const EncryptedMatrix& other) const;
+
+        void multiply_inplace(const EncryptedMatrix& other);
+
+    private:
+        void verify_compatible(const EncryptedMatrix& other) const;
+
+        const FHE* fhe_;
+
+        seal::Ciphertext ciphertext_;
+
+        size_t dimension_;
+    };
+}
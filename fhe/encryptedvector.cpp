@@ -0,0 +1,172 @@
+#include "encryptedvector.h"
+#include <stdexcept>
+
+namespace fhe
+{
+    EncryptedVector::EncryptedVector(const FHE& fhe) :
+        fhe_(&fhe),
+        size_(0) {
+    }
+
+    EncryptedVector::EncryptedVector(const FHE& fhe, std::vector<seal::Ciphertext> shards, const size_t size) :
+        fhe_(&fhe),
+        shards_(std::move(shards)),
+        size_(size) {
+
+        const size_t capacity = shard_capacity();
+        if (shards_.size() != (size_ + capacity - 1) / capacity)
+        {
+            throw std::invalid_argument("The number of shards does not match the vector size.");
+        }
+    }
+
+    size_t EncryptedVector::size() const
+    {
+        return size_;
+    }
+
+    size_t EncryptedVector::shard_capacity() const
+    {
+        return static_cast<size_t>(fhe_->slot_count());
+    }
+
+    const std::vector<seal::Ciphertext>& EncryptedVector::shards() const
+    {
+        return shards_;
+    }
+
+    void EncryptedVector::add(const EncryptedVector& other, EncryptedVector& destination) const
+    {
+        destination = *this;
+        destination.add_inplace(other);
+    }
+
+    EncryptedVector EncryptedVector::add(const EncryptedVector& other) const
+    {
+        EncryptedVector destination(*fhe_);
+        add(other, destination);
+        return destination;
+    }
+
+    void EncryptedVector::add_inplace(const EncryptedVector& other)
+    {
+        verify_compatible(other);
+
+        fhe_->parallel_for(shards_.size(), [&](size_t s)
+        {
+            fhe_->add_inplace(shards_[s], other.shards_[s]);
+        });
+    }
+
+    void EncryptedVector::sub(const EncryptedVector& other, EncryptedVector& destination) const
+    {
+        destination = *this;
+        destination.sub_inplace(other);
+    }
+
+    EncryptedVector EncryptedVector::sub(const EncryptedVector& other) const
+    {
+        EncryptedVector destination(*fhe_);
+        sub(other, destination);
+        return destination;
+    }
+
+    void EncryptedVector::sub_inplace(const EncryptedVector& other)
+    {
+        verify_compatible(other);
+
+        fhe_->parallel_for(shards_.size(), [&](size_t s)
+        {
+            fhe_->sub_inplace(shards_[s], other.shards_[s]);
+        });
+    }
+
+    void EncryptedVector::multiply(const EncryptedVector& other, EncryptedVector& destination) const
+    {
+        destination = *this;
+        destination.multiply_inplace(other);
+    }
+
+    EncryptedVector EncryptedVector::multiply(const EncryptedVector& other) const
+    {
+        EncryptedVector destination(*fhe_);
+        multiply(other, destination);
+        return destination;
+    }
+
+    void EncryptedVector::multiply_inplace(const EncryptedVector& other)
+    {
+        verify_compatible(other);
+
+        fhe_->parallel_for(shards_.size(), [&](size_t s)
+        {
+            fhe_->multiply_inplace(shards_[s], other.shards_[s]);
+        });
+    }
+
+    void EncryptedVector::negate_inplace()
+    {
+        fhe_->parallel_for(shards_.size(), [&](size_t s)
+        {
+            fhe_->negate_inplace(shards_[s]);
+        });
+    }
+
+    void EncryptedVector::sum(seal::Ciphertext& destination) const
+    {
+        if (shards_.empty())
+        {
+            throw std::invalid_argument("The vector must not be empty.");
+        }
+
+        // Adding the shards first leaves a single ciphertext to rotate.
+        fhe_->add_many(shards_, destination);
+        reduce_inplace(destination);
+    }
+
+    seal::Ciphertext EncryptedVector::sum() const
+    {
+        seal::Ciphertext destination;
+        sum(destination);
+        return destination;
+    }
+
+    void EncryptedVector::dot(const EncryptedVector& other, seal::Ciphertext& destination) const
+    {
+        verify_compatible(other);
+
+        if (shards_.empty())
+        {
+            throw std::invalid_argument("The vector must not be empty.");
+        }
+
+        fhe_->sum_of_products(shards_, other.shards_, destination);
+        reduce_inplace(destination);
+    }
+
+    seal::Ciphertext EncryptedVector::dot(const EncryptedVector& other) const
+    {
+        seal::Ciphertext destination;
+        dot(other, destination);
+        return destination;
+    }
+
+    void EncryptedVector::verify_compatible(const EncryptedVector& other) const
+    {
+        if (fhe_ != other.fhe_ || size_ != other.size_)
+        {
+            throw std::invalid_argument("The vectors must have the same size and FHE instance.");
+        }
+    }
+
+    void EncryptedVector::reduce_inplace(seal::Ciphertext& ciphertext) const
+    {
+        fhe_->window_sum_inplace(ciphertext, fhe_->row_size());
+
+        // BGV/BFV hold two rows, which are added with one column rotation.
+        if (fhe_->slot_count() > static_cast<uint64_t>(fhe_->row_size()))
+        {
+            fhe_->column_sum_inplace(ciphertext);
+        }
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "seal/seal.h"
+#include "fhe.h"
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class EncryptedVector
+    An encrypted vector of any length, sharded across as many ciphertexts as needed.
+
+    @details
+    Element `e` is stored in slot `e % slot_count()` of shard `e / slot_count()`. The slots past the end of the
+    vector in the last shard are zero, and every operation keeps them zero, so reductions can include them.
+    Elementwise operations run on the shards in parallel. Global reductions first add all shards with a
+    balanced tree and then reduce the single remaining ciphertext, which costs one in-ciphertext reduction
+    in total instead of one per shard.
+
+    Both operands of a binary operation must have the same length and belong to the same FHE instance,
+    which must outlive the vector.
+    */
+    class EncryptedVector
+    {
+    public:
+        /**
+        Constructs an empty vector.
+
+        @param[in] fhe The FHE instance used for every operation.
+        */
+        explicit EncryptedVector(const FHE& fhe);
+
+        /**
+        Constructs a vector from existing shards.
+
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] shards The shards, with zero slots past `size`.
+        @param[in] size The number of elements.
+
+        @throws std::invalid_argument If the shard count does not match `size`.
+        */
+        EncryptedVector(const FHE& fhe, std::vector<seal::Ciphertext> shards, const size_t size);
+
+        /**
+        Encodes and encrypts a vector, one shard per `slot_count()` elements, in parallel.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] fhe The FHE instance used for every operation.
+        @param[in] values The values to encrypt.
+        @return The encrypted vector.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >static EncryptedVector encrypt(const FHE& fhe, const std::vector<T>& values)
+        {
+            const size_t capacity = static_cast<size_t>(fhe.slot_count());
+            std::vector<seal::Ciphertext> shards((values.size() + capacity - 1) / capacity);
+
+            fhe.parallel_for(shards.size(), [&](size_t s)
+            {
+                const auto begin = values.begin() + s * capacity;
+                const auto end = values.begin() + std::min(values.size(), (s + 1) * capacity);
+
+                seal::Plaintext plain(fhe.memory_pool());
+                fhe.encode(std::vector<T>(begin, end), plain);
+                fhe.encrypt(plain, shards[s]);
+            });
+
+            return EncryptedVector(fhe, std::move(shards), values.size());
+        }
+
+        /**
+        Decrypts and decodes the vector, in parallel over the shards.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[out] destination The vector to be overwritten with the decrypted values.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decrypt(std::vector<T>& destination) const
+        {
+            const size_t capacity = shard_capacity();
+            destination.resize(size_);
+
+            fhe_->parallel_for(shards_.size(), [&](size_t s)
+            {
+                seal::Plaintext plain(fhe_->memory_pool());
+                std::vector<T> values;
+                fhe_->decrypt(shards_[s], plain);
+                fhe_->decode(plain, values);
+
+                const size_t count = std::min(capacity, size_ - s * capacity);
+                std::copy(values.begin(), values.begin() + count, destination.begin() + s * capacity);
+            });
+        }
+
+        /**
+        Decrypts and decodes the vector and returns the values.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @return The decrypted values.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >std::vector<T> decrypt() const
+        {
+            std::vector<T> destination;
+            decrypt(destination);
+            return destination;
+        }
+
+        /**
+        Retrieves the number of elements.
+        */
+        size_t size() const;
+
+        /**
+        Retrieves the number of elements per shard (`slot_count()`).
+        */
+        size_t shard_capacity() const;
+
+        /**
+        Retrieves the shards.
+        */
+        const std::vector<seal::Ciphertext>& shards() const;
+
+        /**
+        Adds two vectors elementwise.
+
+        @param[in] other The vector to add.
+        @param[out] destination The vector to store the result.
+
+        @throws std::invalid_argument If the vectors are not compatible.
+        */
+        void add(const EncryptedVector& other, EncryptedVector& destination) const;
+
+        EncryptedVector add(const EncryptedVector& other) const;
+
+        void add_inplace(const EncryptedVector& other);
+
+        /**
+        Subtracts another vector elementwise.
+
+        @param[in] other The vector to subtract.
+        @param[out] destination The vector to store the result.
+
+        @throws std::invalid_argument If the vectors are not compatible.
+        */
+        void sub(const EncryptedVector& other, EncryptedVector& destination) const;
+
+        EncryptedVector sub(const EncryptedVector& other) const;
+
+        void sub_inplace(const EncryptedVector& other);
+
+        /**
+        Multiplies two vectors elementwise, with relinearization and modulus switching or rescaling as in `FHE::multiply`.
+
+        @param[in] other The vector to multiply by.
+        @param[out] destination The vector to store the result.
+
+        @throws std::invalid_argument If the vectors are not compatible.
+        */
+        void multiply(const EncryptedVector& other, EncryptedVector& destination) const;
+
+        EncryptedVector multiply(const EncryptedVector& other) const;
+
+        void multiply_inplace(const EncryptedVector& other);
+
+        /**
+        Negates every element in place.
+        */
+        void negate_inplace();
+
+        /**
+        Sums all elements.
+
+        @details
+        The shards are added with a balanced tree, and the remaining ciphertext is reduced with `log2(row size)`
+        rotations (plus one column rotation for BGV/BFV).
+
+        @param[out] destination The ciphertext whose slots all hold the sum.
+
+        @throws std::invalid_argument If the vector is empty.
+        */
+        void sum(seal::Ciphertext& destination) const;
+
+        seal::Ciphertext sum() const;
+
+        /**
+        Computes the inner product with another vector.
+
+        @details
+        The shard products are accumulated with `FHE::sum_of_products`, which relinearizes once, and then reduced
+        as in `sum`.
+
+        @param[in] other The other vector.
+        @param[out] destination The ciphertext whose slots all hold the inner product.
+
+        @throws std::invalid_argument If the vectors are empty or not compatible.
+        */
+        void dot(const EncryptedVector& other, seal::Ciphertext& destination) const;
+
+        seal::Ciphertext dot(const EncryptedVector& other) const;
+
+    private:
+        void verify_compatible(const EncryptedVector& other) const;
+
+        void reduce_inplace(seal::Ciphertext& ciphertext) const;
+
+        const FHE* fhe_;
+
+        std::vector<seal::Ciphertext> shards_;
+
+        size_t size_;
+    };
+}
@@ -0,0 +1,243 @@
+#include "executor.h"
+#include <algorithm>
+#include <chrono>
+
+namespace fhe
+{
+    namespace
+    {
+        // The executor whose worker the calling thread is, and its index there.
+        thread_local const Executor* current_executor = nullptr;
+
+        thread_local size_t current_index = 0;
+    }
+
+    void async_state_t::complete(std::exception_ptr error)
+    {
+        std::vector<std::function<void()>> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exception = error;
+            ready = true;
+            pending.swap(continuations);
+        }
+
+        done.notify_all();
+        for (std::function<void()>& continuation : pending)
+        {
+            continuation();
+        }
+    }
+
+    void async_state_t::on_ready(std::function<void()> continuation)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ready)
+            {
+                continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+
+        continuation();
+    }
+
+    bool async_state_t::is_ready()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ready;
+    }
+
+    Executor::Executor(const size_t thread_count) :
+        queued_(0),
+        outstanding_(0),
+        stopping_(false) {
+
+        const size_t count = thread_count > 0 ? thread_count : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        queues_.reserve(count);
+        for (size_t t = 0; t < count; t++)
+        {
+            queues_.push_back(std::make_unique<queue_t>());
+        }
+
+        workers_.reserve(count);
+        for (size_t t = 0; t < count; t++)
+        {
+            workers_.emplace_back(&Executor::worker_loop, this, t);
+        }
+    }
+
+    Executor::~Executor()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return outstanding_ == 0; });
+            stopping_ = true;
+        }
+
+        condition_.notify_all();
+        for (std::thread& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    size_t Executor::thread_count() const
+    {
+        return workers_.size();
+    }
+
+    void Executor::wait(async_state_t& state)
+    {
+        const size_t worker = current_worker();
+
+        if (worker == workers_.size())
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.done.wait(lock, [&state] { return state.ready; });
+            return;
+        }
+
+        std::function<void()> task;
+        while (!state.is_ready())
+        {
+            if (take(worker, task))
+            {
+                run(task);
+                continue;
+            }
+
+            // Nothing is queued, but the operations still running may queue more, so the wait is bounded.
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.done.wait_for(lock, std::chrono::milliseconds(1), [&state] { return state.ready; });
+        }
+    }
+
+    void Executor::submit(const std::vector<std::shared_ptr<async_state_t>>& inputs, std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            outstanding_++;
+        }
+
+        auto pending = std::make_shared<pending_t>();
+        pending->inputs = inputs.size() + 1;
+        pending->task = std::move(task);
+
+        // The last input to finish (or this call, if all of them already have) queues the task.
+        auto release = [this, pending]()
+        {
+            if (--pending->inputs == 0)
+            {
+                schedule(std::move(pending->task));
+            }
+        };
+
+        for (const std::shared_ptr<async_state_t>& input : inputs)
+        {
+            input->on_ready(release);
+        }
+
+        release();
+    }
+
+    void Executor::schedule(std::function<void()> task)
+    {
+        const size_t worker = current_worker();
+        queue_t& queue = worker < queues_.size() ? *queues_[worker] : shared_queue_;
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_++;
+        }
+
+        condition_.notify_one();
+    }
+
+    bool Executor::take(const size_t worker, std::function<void()>& task)
+    {
+        bool found = false;
+
+        {
+            std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+            std::deque<std::function<void()>>& tasks = queues_[worker]->tasks;
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                found = true;
+            }
+        }
+
+        for (size_t offset = 0; !found && offset < queues_.size(); offset++)
+        {
+            queue_t& victim = offset == 0 ? shared_queue_ : *queues_[(worker + offset) % queues_.size()];
+
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_--;
+        }
+
+        return found;
+    }
+
+    void Executor::run(std::function<void()>& task)
+    {
+        // Tasks store their exceptions in their futures, so they never throw.
+        task();
+        task = nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--outstanding_ == 0)
+        {
+            idle_.notify_all();
+        }
+    }
+
+    void Executor::worker_loop(const size_t worker)
+    {
+        current_executor = this;
+        current_index = worker;
+
+        std::function<void()> task;
+        while (true)
+        {
+            if (take(worker, task))
+            {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+
+            if (stopping_ && queued_ == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    size_t Executor::current_worker() const
+    {
+        return current_executor == this ? current_index : workers_.size();
+    }
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fhe
+{
+    class Executor;
+
+    /**
+    The completion state shared by an asynchronous operation and its futures.
+    */
+    struct async_state_t
+    {
+        std::mutex mutex;
+
+        std::condition_variable done;
+
+        bool ready = false;
+
+        std::exception_ptr exception = nullptr;
+
+        std::vector<std::function<void()>> continuations;
+
+        /**
+        Marks the operation as finished, wakes its waiters and runs its continuations on the calling thread.
+        */
+        void complete(std::exception_ptr error);
+
+        /**
+        Runs `continuation` once the operation has finished, immediately if it already has.
+        */
+        void on_ready(std::function<void()> continuation);
+
+        bool is_ready();
+    };
+
+    /**
+    @class Future
+    A handle to the result of an operation queued on an `Executor`.
+
+    @details
+    Copies of a future share the same result. The result is written once by the operation and is read-only
+    afterwards, so any number of threads may wait on it and read it, and it can be passed to further
+    operations, which start as soon as all of their inputs are ready.
+
+    @tparam T The type of the result.
+    */
+    template <typename T>
+    class Future
+    {
+    public:
+        /**
+        Constructs a future without an operation.
+        */
+        Future() = default;
+
+        /**
+        Constructs a future that is already ready with the given value.
+
+        @param[in] value The result.
+        */
+        static Future ready_value(T value)
+        {
+            auto state = std::make_shared<state_t>();
+            state->value.emplace(std::move(value));
+            state->ready = true;
+            return Future(std::move(state), nullptr);
+        }
+
+        /**
+        Checks whether the future refers to an operation.
+        */
+        bool valid() const
+        {
+            return state_ != nullptr;
+        }
+
+        /**
+        Checks whether the operation has finished, without blocking.
+        */
+        bool ready() const
+        {
+            verify_valid();
+            return state_->is_ready();
+        }
+
+        /**
+        Blocks until the operation has finished.
+
+        @details
+        On one of the executor's own threads, queued operations are run while waiting, so an operation
+        may wait on another one without tying up its thread.
+
+        @throws std::invalid_argument If the future does not refer to an operation.
+        */
+        void wait() const;
+
+        /**
+        Blocks until the operation has finished and returns its result.
+
+        @return A reference to the result, which lives as long as any copy of the future.
+
+        @throws std::invalid_argument If the future does not refer to an operation.
+        @throws The exception thrown by the operation or by any operation it depends on.
+        */
+        const T& get() const
+        {
+            wait();
+
+            if (state_->exception)
+            {
+                std::rethrow_exception(state_->exception);
+            }
+
+            return *state_->value;
+        }
+
+    private:
+        friend class Executor;
+
+        struct state_t : async_state_t
+        {
+            std::optional<T> value;
+        };
+
+        Future(std::shared_ptr<state_t> state, Executor* executor) :
+            state_(std::move(state)),
+            executor_(executor) {
+        }
+
+        void verify_valid() const
+        {
+            if (!state_)
+            {
+                throw std::invalid_argument("The future does not refer to an operation.");
+            }
+        }
+
+        std::shared_ptr<state_t> state_;
+
+        Executor* executor_ = nullptr;
+    };
+
+    /**
+    @class Executor
+    A work-stealing thread pool that runs operations as soon as their inputs are ready.
+
+    @details
+    Every worker thread has its own queue. An operation that becomes ready on a worker, typically because
+    the operation that worker just finished was its last missing input, is pushed to that worker's queue
+    and taken from its back, so chains of dependent operations stay on one thread while their data is hot.
+    Operations submitted from other threads go to a shared queue. An idle worker takes from the shared
+    queue and otherwise steals from the front of another worker's queue, so independent branches of a
+    circuit spread over all threads without the caller managing any of them.
+
+    Operations must not block on anything but futures of the same executor; waiting on a future from a
+    worker runs other queued operations in the meantime.
+    */
+    class Executor
+    {
+    public:
+        /**
+        Creates an executor and starts its worker threads.
+
+        @param[in] thread_count The number of worker threads. If 0, the number of hardware threads is used.
+        */
+        explicit Executor(const size_t thread_count);
+
+        /**
+        Waits for every submitted operation to finish, then stops and joins the worker threads.
+        Must not be called from a worker thread.
+        */
+        ~Executor();
+
+        Executor(const Executor&) = delete;
+
+        Executor& operator=(const Executor&) = delete;
+
+        /**
+        Retrieves the number of worker threads.
+        */
+        size_t thread_count() const;
+
+        /**
+        Queues `function(inputs.get()...)` to run once every input is ready.
+
+        @details
+        The call returns immediately. If an input fails, `function` is not called and the returned future
+        carries the input's exception; an exception thrown by `function` is carried the same way.
+
+        @param[in] function The operation. It receives the results of the inputs as const references and
+        must return a value.
+        @param[in] inputs The futures whose results the operation reads.
+        @return A future for the result of the operation.
+
+        @throws std::invalid_argument If an input does not refer to an operation.
+        */
+        template <typename F, typename... Args>
+        auto then(F&& function, const Future<Args>&... inputs) -> Future<std::decay_t<std::invoke_result_t<F&, const Args&...>>>
+        {
+            using R = std::decay_t<std::invoke_result_t<F&, const Args&...>>;
+            static_assert(!std::is_void<R>::value, "The operation must return a value.");
+
+            (inputs.verify_valid(), ...);
+
+            auto state = std::make_shared<typename Future<R>::state_t>();
+
+            submit({ inputs.state_... }, [state, function = std::forward<F>(function), inputs...]() mutable
+            {
+                std::exception_ptr exception = nullptr;
+
+                // The first failed input fails the operation without running it.
+                ((exception = exception ? exception : inputs.state_->exception), ...);
+
+                if (!exception)
+                {
+                    try
+                    {
+                        state->value.emplace(function(std::as_const(*inputs.state_->value)...));
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+                }
+
+                state->complete(exception);
+            });
+
+            return Future<R>(std::move(state), this);
+        }
+
+        /**
+        Blocks until the given operation has finished, running queued operations meanwhile on a worker thread.
+        */
+        void wait(async_state_t& state);
+
+    private:
+        struct queue_t
+        {
+            std::mutex mutex;
+
+            std::deque<std::function<void()>> tasks;
+        };
+
+        struct pending_t
+        {
+            std::atomic<size_t> inputs;
+
+            std::function<void()> task;
+        };
+
+        void submit(const std::vector<std::shared_ptr<async_state_t>>& inputs, std::function<void()> task);
+
+        void schedule(std::function<void()> task);
+
+        /**
+        Takes a task from the worker's own queue (newest first), the shared queue, or another worker's queue (oldest first).
+        */
+        bool take(const size_t worker, std::function<void()>& task);
+
+        void run(std::function<void()>& task);
+
+        void worker_loop(const size_t worker);
+
+        /**
+        Retrieves the index of the calling thread among this executor's workers, or `thread_count()` for any other thread.
+        */
+        size_t current_worker() const;
+
+        std::vector<std::unique_ptr<queue_t>> queues_;
+
+        queue_t shared_queue_;
+
+        std::vector<std::thread> workers_;
+
+        std::mutex mutex_;
+
+        std::condition_variable condition_;
+
+        std::condition_variable idle_;
+
+        size_t queued_;
+
+        size_t outstanding_;
+
+        bool stopping_;
+    };
+
+    template <typename T>
+    void Future<T>::wait() const
+    {
+        verify_valid();
+
+        if (executor_)
+        {
+            executor_->wait(*state_);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            state_->done.wait(lock, [this] { return state_->ready; });
+        }
+    }
+}
@@ -1,5 +1,9 @@
 #include "FHE.h"
+#include "seal/util/ntt.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace fhe
 {
@@ -27,10 +31,14 @@ namespace fhe
         decryptor_(std::move(decryptor)),
         evaluator_(std::move(evaluator)),
         mul_mode_(mul_mode),
+        mod_switch_policy_(mod_switch_policy_t::eager),
+        mod_switch_level_(1),
         secret_key_(secret_key),
         public_key_(public_key),
         relin_keys_(relin_keys),
-        galois_keys_(galois_keys) {
+        galois_keys_(galois_keys),
+        thread_count_(0),
+        thread_local_memory_pools_(false) {
     }
 
     FHE::FHE(
@@ -58,10 +66,24 @@ namespace fhe
         decryptor_(std::move(decryptor)),
         evaluator_(std::move(evaluator)),
         mul_mode_(mul_mode),
+        mod_switch_policy_(mod_switch_policy_t::eager),
+        mod_switch_level_(1),
         secret_key_(secret_key),
         public_key_(public_key),
         relin_keys_(relin_keys),
-        galois_keys_(galois_keys) {
+        galois_keys_(galois_keys),
+        thread_count_(0),
+        thread_local_memory_pools_(false) {
+        // The scale of each level is the scale that a product of two ciphertexts at the level above carries after rescaling.
+        // It is computed in the same order as SEAL (multiply, then divide by the dropped prime), so the results are bit-identical.
+        level_scales_.resize(context_->first_context_data()->chain_index() + 1);
+
+        double_t level_scale = scale_;
+        for (auto context_data = context_->first_context_data(); context_data; context_data = context_data->next_context_data())
+        {
+            level_scales_[context_data->chain_index()] = level_scale;
+            level_scale = level_scale * level_scale / static_cast<double_t>(context_data->parms().coeff_modulus().back().value());
+        }
     }
 
     void FHE::scheme(std::string& destination) const 
@@ -193,6 +215,61 @@ namespace fhe
         return destination;
     }
 
+    void FHE::galois_keys_size(size_t& destination) const
+    {
+        destination = static_cast<size_t>(galois_keys_.save_size(seal::compr_mode_type::none));
+    }
+
+    size_t FHE::galois_keys_size() const
+    {
+        size_t destination = 0;
+        galois_keys_size(destination);
+        return destination;
+    }
+
+    void FHE::route_rotations(const std::vector<int32_t>& key_steps)
+    {
+        std::vector<int32_t> keys;
+        for (const int32_t step : key_steps)
+        {
+            const int32_t normalized = normalize_step(step);
+            if (normalized != 0)
+            {
+                keys.push_back(normalized);
+            }
+        }
+
+        rotation_routes_ = keys.empty() ? std::vector<int32_t>() : rotation_route_table(keys, row_size());
+    }
+
+    void FHE::thread_count(const size_t count)
+    {
+        std::lock_guard<std::mutex> lock(thread_pool_mutex_);
+        thread_count_ = count;
+        thread_pool_.reset();
+    }
+
+    size_t FHE::thread_count() const
+    {
+        return thread_count_ > 0 ? thread_count_ : std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    void FHE::parallel_for(const size_t count, const std::function<void(size_t)>& task) const
+    {
+        thread_pool().parallel_for(count, task);
+    }
+
+    ThreadPool& FHE::thread_pool() const
+    {
+        // The pool is started on first use, so that configuring the thread count never starts a pool for nothing.
+        std::lock_guard<std::mutex> lock(thread_pool_mutex_);
+        if (!thread_pool_)
+        {
+            thread_pool_ = std::make_unique<ThreadPool>(thread_count_);
+        }
+        return *thread_pool_;
+    }
+
     void FHE::plain_modulus_primitive_root(const uint64_t n, uint64_t& destination) const 
     {
         // Verify scheme.
@@ -233,14 +310,166 @@ namespace fhe
         return destination;
     }
 
+    void FHE::level_scale(const seal::parms_id_type& parms_id, double_t& destination) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        const auto context_data = context_->get_context_data(parms_id);
+
+        if (!context_data || context_data->chain_index() >= level_scales_.size())
+        {
+            throw std::invalid_argument("The parameters are not valid for encoding or encryption.");
+        }
+
+        destination = level_scales_[context_data->chain_index()];
+    }
+
+    double_t FHE::level_scale(const seal::parms_id_type& parms_id) const
+    {
+        double_t destination = -1;
+        level_scale(parms_id, destination);
+        return destination;
+    }
+
+    void FHE::coeff_modulus(const seal::parms_id_type& parms_id, std::vector<seal::Modulus>& destination) const
+    {
+        const auto context_data = context_->get_context_data(parms_id);
+
+        if (!context_data)
+        {
+            throw std::invalid_argument("The parameters are not valid for the encryption parameters.");
+        }
+
+        destination = context_data->parms().coeff_modulus();
+    }
+
+    std::vector<seal::Modulus> FHE::coeff_modulus(const seal::parms_id_type& parms_id) const
+    {
+        std::vector<seal::Modulus> destination;
+        coeff_modulus(parms_id, destination);
+        return destination;
+    }
+
     mul_mode_t& FHE::mul_mode()
     {
         return mul_mode_;
     }
 
+    mod_switch_policy_t& FHE::mod_switch_policy()
+    {
+        return mod_switch_policy_;
+    }
+
+    size_t& FHE::mod_switch_level()
+    {
+        return mod_switch_level_;
+    }
+
+    bool& FHE::thread_local_memory_pools()
+    {
+        return thread_local_memory_pools_;
+    }
+
+    seal::MemoryPoolHandle FHE::memory_pool() const
+    {
+        return thread_local_memory_pools_ ? seal::MemoryPoolHandle::ThreadLocal() : seal::MemoryManager::GetPool();
+    }
+
+    seal::Ciphertext FHE::acquire_ciphertext(const seal::parms_id_type& parms_id) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(free_list_mutex_);
+
+            auto it = free_ciphertexts_.find(parms_id);
+            if (it != free_ciphertexts_.end() && !it->second.empty())
+            {
+                seal::Ciphertext ciphertext = std::move(it->second.back());
+                it->second.pop_back();
+                return ciphertext;
+            }
+        }
+
+        // Room for three polynomials, so that an unrelinearized product fits as well.
+        return seal::Ciphertext(*context_, parms_id, 3, seal::MemoryManager::GetPool());
+    }
+
+    void FHE::release(seal::Ciphertext&& ciphertext) const
+    {
+        seal::Ciphertext buffer = std::move(ciphertext);
+
+        // A buffer from a thread-local pool must be freed on its own thread, so it is never shared.
+        if (buffer.size_capacity() == 0 || buffer.pool() != seal::MemoryManager::GetPool())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(free_list_mutex_);
+
+        std::vector<seal::Ciphertext>& buffers = free_ciphertexts_[buffer.parms_id()];
+        if (buffers.size() < 4 * thread_count())
+        {
+            buffers.push_back(std::move(buffer));
+        }
+    }
+
+    void FHE::release_all(std::vector<seal::Ciphertext>& ciphertexts) const
+    {
+        for (seal::Ciphertext& ciphertext : ciphertexts)
+        {
+            release(std::move(ciphertext));
+        }
+    }
+
+    seal::Plaintext FHE::acquire_plaintext() const
+    {
+        {
+            std::lock_guard<std::mutex> lock(free_list_mutex_);
+
+            if (!free_plaintexts_.empty())
+            {
+                seal::Plaintext plaintext = std::move(free_plaintexts_.back());
+                free_plaintexts_.pop_back();
+                return plaintext;
+            }
+        }
+
+        // CKKS plaintexts hold one polynomial per prime of the first level; BGV/BFV plaintexts a single one.
+        const auto context_data = context_->first_context_data();
+        size_t capacity = context_data->parms().poly_modulus_degree();
+        if (scheme_ == seal::scheme_type::ckks)
+        {
+            capacity *= context_data->parms().coeff_modulus().size();
+        }
+
+        seal::Plaintext plaintext(seal::MemoryManager::GetPool());
+        plaintext.reserve(capacity);
+        return plaintext;
+    }
+
+    void FHE::release(seal::Plaintext&& plaintext) const
+    {
+        seal::Plaintext buffer = std::move(plaintext);
+
+        if (buffer.capacity() == 0 || buffer.pool() != seal::MemoryManager::GetPool())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(free_list_mutex_);
+
+        if (free_plaintexts_.size() < 4 * thread_count())
+        {
+            free_plaintexts_.push_back(std::move(buffer));
+        }
+    }
+
     void FHE::encrypt(const seal::Plaintext& plaintext, seal::Ciphertext& destination) const 
     {
-        encryptor_->encrypt(plaintext, destination);
+        encryptor_->encrypt(plaintext, destination, memory_pool());
     }
 
     seal::Ciphertext FHE::encrypt(const seal::Plaintext& plaintext) const
@@ -289,15 +518,30 @@ namespace fhe
 
         destination1 = ciphertext1;
         destination2 = ciphertext2;
+        mod_matching_inplace(destination1, destination2);
+    }
+
+    void FHE::mod_matching_inplace(seal::Ciphertext& ciphertext1, seal::Ciphertext& ciphertext2) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
 
-        if (destination1.coeff_modulus_size() > destination2.coeff_modulus_size()) 
+        if (ciphertext1.coeff_modulus_size() == ciphertext2.coeff_modulus_size())
         {
-            std::swap(destination1, destination2);
+            throw std::invalid_argument("The modulus sizes of both ciphertexts are already equal");
         }
 
-        while (destination1.coeff_modulus_size() != destination2.coeff_modulus_size())
+        // Only the ciphertext with the larger modulus is switched down.
+        if (ciphertext1.coeff_modulus_size() > ciphertext2.coeff_modulus_size())
         {
-            evaluator_->mod_switch_to_next_inplace(destination2);
+            level_down_inplace(ciphertext1, ciphertext2);
+        }
+        else
+        {
+            level_down_inplace(ciphertext2, ciphertext1);
         }
     }
 
@@ -339,26 +583,51 @@ namespace fhe
         }
 
         // In the CKKS scheme, if encoded with the same settings, ciphertexts with the same modulus size have the same scale. However, the reverse is not guaranteed.
-        // To match the scale and modulus size, multiply by a plaintext of 1 and perform rescaling.
+        // To match the modulus size, the primes that are not needed are dropped by modulus switching, which leaves the scale untouched.
+        // If the scales also differ, the correction is folded into a single multiplication by a constant followed by one rescale.
         // Alternatively, after a multiplication operation, one could enforce the scale to a default value during rescaling, but this can result in cumulative errors.
         // For example, if the scale is set to 2^40, rescaling divides the scale by a very large 40-bit prime number.
         // Since this 40-bit prime is smaller than 2^40, the scale after rescaling becomes larger than 2^40.
         destination1 = ciphertext1;
         destination2 = ciphertext2;
-        
-        if (destination1.coeff_modulus_size() > destination2.coeff_modulus_size()) 
+        mod_scale_matching_inplace(destination1, destination2);
+    }
+
+    void FHE::mod_scale_matching_inplace(seal::Ciphertext& ciphertext1, seal::Ciphertext& ciphertext2) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        if (ciphertext1.scale() == ciphertext2.scale() && ciphertext1.coeff_modulus_size() == ciphertext2.coeff_modulus_size())
         {
-            std::swap(destination1, destination2);
+            throw std::invalid_argument("The modulus sizes and scales of both ciphertexts are already equal.");
         }
-   
-        seal::Plaintext plain;
 
-        while (destination1.coeff_modulus_size() != destination2.coeff_modulus_size()) 
+        // Only the ciphertext with the larger modulus size is brought down.
+        if (ciphertext1.coeff_modulus_size() > ciphertext2.coeff_modulus_size())
+        {
+            level_down_inplace(ciphertext1, ciphertext2);
+        }
+        else if (ciphertext1.coeff_modulus_size() < ciphertext2.coeff_modulus_size())
+        {
+            level_down_inplace(ciphertext2, ciphertext1);
+        }
+        else
         {
-            ckks_encoder_->encode(1, destination2.parms_id(), destination2.scale(), plain);
-            evaluator_->multiply_plain_inplace(destination2, plain);
-            evaluator_->relinearize_inplace(destination2, relin_keys_);
-            evaluator_->rescale_to_next_inplace(destination2);
+            // The scales differ at the same level. A scale can only be corrected while dropping a level,
+            // so the first ciphertext is corrected on the way down and the second one follows by modulus switching.
+            const auto next_context_data = context_->get_context_data(ciphertext1.parms_id())->next_context_data();
+
+            if (!next_context_data)
+            {
+                throw std::invalid_argument("The scales cannot be matched because no level is left to drop.");
+            }
+
+            mod_scale_switch_to_inplace(ciphertext1, next_context_data->parms_id(), ciphertext2.scale());
+            evaluator_->mod_switch_to_inplace(ciphertext2, next_context_data->parms_id(), memory_pool());
         }
     }
 
@@ -391,391 +660,2122 @@ namespace fhe
         }
     }
 
-    void FHE::add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const
+    void FHE::level_down_inplace(seal::Ciphertext& ciphertext, const seal::Ciphertext& target) const
     {
-        auto add_cipher = [this](const seal::Ciphertext& cipher1, const seal::Ciphertext& cipher2, seal::Ciphertext& dest) 
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // For BGV/BFV schemes, the ciphertext can be switched directly to the target parameters.
+            evaluator_->mod_switch_to_inplace(ciphertext, target.parms_id(), memory_pool());
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
         {
-            evaluator_->add(cipher1, cipher2, dest);
-        };
+            // For CKKS schemes, both the parameters and the scale of the target are matched.
+            mod_scale_switch_to_inplace(ciphertext, target.parms_id(), target.scale());
+        }
+    }
 
-        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+    void FHE::mod_scale_switch_to_inplace(seal::Ciphertext& ciphertext, const seal::parms_id_type& parms_id, const double_t scale) const
+    {
+        const auto context_data = context_->get_context_data(ciphertext.parms_id());
+        const auto target_context_data = context_->get_context_data(parms_id);
+
+        if (!context_data || !target_context_data || context_data->chain_index() < target_context_data->chain_index())
         {
-            // For BGV and BFV schemes, modulus sizes of the two ciphertexts must be matched before addition.
-            if (mod_compare(ciphertext1, ciphertext2)) 
+            throw std::invalid_argument("The target parameters must be at or below the level of the ciphertext.");
+        }
+
+        if (ciphertext.scale() == scale)
+        {
+            // The scale already agrees, so dropping the unneeded primes is enough.
+            if (ciphertext.parms_id() != parms_id)
             {
-                add_cipher(ciphertext1, ciphertext2, destination);
+                evaluator_->mod_switch_to_inplace(ciphertext, parms_id, memory_pool());
             }
-            else 
-            {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
+            return;
+        }
 
-                mod_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                add_cipher(cipher1, cipher2, destination);
-            }
+        if (context_data->chain_index() == target_context_data->chain_index())
+        {
+            throw std::invalid_argument("The scale cannot be corrected without dropping a level.");
         }
-        else if (scheme_ == seal::scheme_type::ckks)
+
+        // The correction is applied by one multiplication and one rescale, so it starts from the level right above the target.
+        const auto upper_context_data = target_context_data->prev_context_data();
+
+        // Rescaling divides by the last prime of the upper level, so a constant 1 encoded at
+        // (scale * prime / current scale) lands exactly on the target scale.
+        const double_t correction = scale * static_cast<double_t>(upper_context_data->parms().coeff_modulus().back().value()) / ciphertext.scale();
+
+        // The constant is encoded as round(correction), i.e. to a relative precision of 1 / (2 * correction). Below
+        // the encoding scale (with some slack for the prime sizes) that error would exceed the ciphertext's own.
+        if (correction < scale_ / 16)
         {
-            // For CKKS schemes, modulus sizes and scales of the two ciphertexts must be matched before addition.
-            if (mod_scale_compare(ciphertext1, ciphertext2)) {
-                add_cipher(ciphertext1, ciphertext2, destination);
-            }
-            else 
-            {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
+            throw std::invalid_argument("The scale correction is too small to be applied precisely in one rescale.");
+        }
 
-                mod_scale_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                add_cipher(cipher1, cipher2, destination);
-            }
+        // Drop to the level above the target without touching the scale.
+        if (ciphertext.parms_id() != upper_context_data->parms_id())
+        {
+            evaluator_->mod_switch_to_inplace(ciphertext, upper_context_data->parms_id(), memory_pool());
         }
-    }
 
-    seal::Ciphertext FHE::add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
-    {
-        seal::Ciphertext destination;
-        add(ciphertext1, ciphertext2, destination);
-        return destination;
+        seal::Plaintext plain(memory_pool());
+        ckks_encoder_->encode(1.0, ciphertext.parms_id(), correction, plain);
+        evaluator_->multiply_plain_inplace(ciphertext, plain, memory_pool());
+        evaluator_->rescale_to_next_inplace(ciphertext, memory_pool());
+
+        // Only floating-point rounding may separate the computed scale from the target; anything more is an error.
+        if (std::fabs(ciphertext.scale() - scale) > scale * 8 * std::numeric_limits<double_t>::epsilon())
+        {
+            throw std::invalid_argument("The scale correction did not reach the target scale.");
+        }
+
+        ciphertext.scale() = scale;
     }
 
-    void FHE::add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const
+    const seal::Ciphertext& FHE::level_matching(seal::Ciphertext& destination, const seal::Ciphertext& operand, seal::Ciphertext& buffer) const
     {
-        auto add_plain = [this](const seal::Ciphertext& cipher, const seal::Plaintext& plain, seal::Ciphertext& dest) 
+        if (destination.coeff_modulus_size() > operand.coeff_modulus_size())
         {
-            evaluator_->add_plain(cipher, plain, dest);
-        };
-
-        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+            // The destination is modified anyway, so it is lowered in place.
+            level_down_inplace(destination, operand);
+            return operand;
+        }
+        else if (destination.coeff_modulus_size() < operand.coeff_modulus_size())
         {
-            // For BGV and BFV schemes, modulus switching for plaintext is not required before addition.
-            add_plain(ciphertext, plaintext, destination);
+            // The operand is read-only, so only this operand is copied.
+            buffer = operand;
+            level_down_inplace(buffer, destination);
+            return buffer;
         }
-        else if (scheme_ == seal::scheme_type::ckks)
+        else if (scheme_ == seal::scheme_type::ckks && destination.scale() != operand.scale())
         {
-            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before addition.
-            if (mod_scale_compare(ciphertext, plaintext))
+            // The scales differ at the same level. The destination is corrected while dropping one level
+            // and the operand follows by modulus switching, which keeps its scale.
+            const auto next_context_data = context_->get_context_data(destination.parms_id())->next_context_data();
+
+            if (!next_context_data)
             {
-                add_plain(ciphertext, plaintext, destination);
+                throw std::invalid_argument("The scales cannot be matched because no level is left to drop.");
             }
-            else
-            {
-                seal::Plaintext plain;
 
-                mod_scale_matching(ciphertext, plaintext, plain);
-                add_plain(ciphertext, plain, destination);
-            }
+            mod_scale_switch_to_inplace(destination, next_context_data->parms_id(), operand.scale());
+            evaluator_->mod_switch_to(operand, next_context_data->parms_id(), buffer, memory_pool());
+            return buffer;
         }
+
+        return operand;
     }
 
-    seal::Ciphertext FHE::add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const 
+    void FHE::level_matching_many(const std::vector<seal::Ciphertext>& ciphertexts, std::vector<seal::Ciphertext>& buffers, std::vector<const seal::Ciphertext*>& aligned) const
     {
-        seal::Ciphertext destination;
-        add(ciphertext, plaintext, destination);
-        return destination;
+        std::vector<const seal::Ciphertext*> operands;
+        operands.reserve(ciphertexts.size());
+
+        for (const seal::Ciphertext& ciphertext : ciphertexts)
+        {
+            operands.push_back(&ciphertext);
+        }
+
+        level_matching_many(operands, buffers, aligned);
     }
 
-    void FHE::sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const 
+    void FHE::level_matching_many(const std::vector<const seal::Ciphertext*>& ciphertexts, std::vector<seal::Ciphertext>& buffers, std::vector<const seal::Ciphertext*>& aligned) const
     {
-        auto sub_cipher = [this](const seal::Ciphertext& cipher1, const seal::Ciphertext& cipher2, seal::Ciphertext& dest) 
+        // The lowest level among the inputs is the common target.
+        const seal::Ciphertext* target = ciphertexts[0];
+        for (const seal::Ciphertext* ciphertext : ciphertexts)
         {
-            evaluator_->sub(cipher1, cipher2, dest);
-        };
+            if (ciphertext->coeff_modulus_size() < target->coeff_modulus_size()) target = ciphertext;
+        }
 
-        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        seal::parms_id_type target_parms_id = target->parms_id();
+        const double_t target_scale = target->scale();
+
+        if (scheme_ == seal::scheme_type::ckks)
         {
-            // For BGV and BFV schemes, modulus sizes of the two ciphertexts must be matched before subtraction.
-            if (mod_compare(ciphertext1, ciphertext2)) {
-                sub_cipher(ciphertext1, ciphertext2, destination);
-            }
-            else 
+            // A scale can only be corrected while dropping a level, so a scale mismatch at the target level moves the target one level down.
+            for (const seal::Ciphertext* ciphertext : ciphertexts)
             {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
+                if (ciphertext->parms_id() == target_parms_id && ciphertext->scale() != target_scale)
+                {
+                    const auto next_context_data = context_->get_context_data(target_parms_id)->next_context_data();
+
+                    if (!next_context_data)
+                    {
+                        throw std::invalid_argument("The scales cannot be matched because no level is left to drop.");
+                    }
 
-                mod_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                sub_cipher(cipher1, cipher2, destination);
+                    target_parms_id = next_context_data->parms_id();
+                    break;
+                }
             }
         }
-        else if (scheme_ == seal::scheme_type::ckks)
+
+        buffers.resize(ciphertexts.size());
+        aligned.resize(ciphertexts.size());
+
+        parallel_for(ciphertexts.size(), [&](size_t i)
         {
-            // For CKKS schemes, modulus sizes and scales of the two ciphertexts must be matched before subtraction.
-            if (mod_scale_compare(ciphertext1, ciphertext2))
+            const seal::Ciphertext& ciphertext = *ciphertexts[i];
+
+            if (ciphertext.parms_id() == target_parms_id && (scheme_ != seal::scheme_type::ckks || ciphertext.scale() == target_scale))
             {
-                sub_cipher(ciphertext1, ciphertext2, destination);
+                aligned[i] = &ciphertext;
+                return;
             }
-            else 
-            {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
 
-                mod_scale_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                sub_cipher(cipher1, cipher2, destination);
+            buffers[i] = acquire_ciphertext(ciphertext.parms_id());
+            buffers[i] = ciphertext;
+            if (scheme_ == seal::scheme_type::ckks)
+            {
+                mod_scale_switch_to_inplace(buffers[i], target_parms_id, target_scale);
             }
-        }
+            else
+            {
+                evaluator_->mod_switch_to_inplace(buffers[i], target_parms_id, memory_pool());
+            }
+            aligned[i] = &buffers[i];
+        });
     }
 
-    seal::Ciphertext FHE::sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const 
+    void FHE::encode_scalar(const int64_t scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const
     {
-        seal::Ciphertext destination;
-        sub(ciphertext1, ciphertext2, destination);
-        return destination;
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // A constant polynomial is decoded to the same value in every slot, so no batching is needed.
+            const seal::Modulus& plain_modulus = context_->key_context_data()->parms().plain_modulus();
+            const uint64_t magnitude = scalar < 0 ? 0 - static_cast<uint64_t>(scalar) : static_cast<uint64_t>(scalar);
+            const uint64_t reduced = magnitude % plain_modulus.value();
+
+            destination.resize(1);
+            destination[0] = (scalar < 0 && reduced != 0) ? plain_modulus.value() - reduced : reduced;
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            encode_scalar(static_cast<double_t>(scalar), ciphertext, destination);
+        }
     }
 
-    void FHE::sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const 
+    void FHE::encode_scalar(const double_t scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const
     {
-        auto sub_plain = [this](const seal::Ciphertext& cipher, const seal::Plaintext& plain, seal::Ciphertext& dest) 
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            encode_scalar(static_cast<int64_t>(scalar), ciphertext, destination);
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
         {
-            evaluator_->sub_plain(cipher, plain, dest);
-        };
+            // The CKKS encoder writes a real constant directly into every RNS component without an FFT.
+            ckks_encoder_->encode(scalar, ciphertext.parms_id(), ciphertext.scale(), destination);
+        }
+    }
 
+    void FHE::encode_scalar(const std::complex<double_t> scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const
+    {
         if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
         {
-            // For BGV and BFV schemes, modulus switching for plaintext is not required before subtraction.
-            sub_plain(ciphertext, plaintext, destination);
+            encode_scalar(static_cast<int64_t>(scalar.real()), ciphertext, destination);
         }
         else if (scheme_ == seal::scheme_type::ckks)
         {
-            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before subtraction.
-            if (mod_scale_compare(ciphertext, plaintext))
+            if (scalar.imag() == 0)
             {
-                sub_plain(ciphertext, plaintext, destination);
+                encode_scalar(scalar.real(), ciphertext, destination);
             }
             else
             {
-                seal::Plaintext plain;
-
-                mod_scale_matching(ciphertext, plaintext, plain);
-                sub_plain(ciphertext, plain, destination);
+                // A constant with a nonzero imaginary part is not a constant polynomial, so the full vector is encoded.
+                ckks_encoder_->encode(scalar, ciphertext.parms_id(), ciphertext.scale(), destination);
             }
         }
     }
 
-    seal::Ciphertext FHE::sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const 
+    void FHE::multiply_integer_inplace(seal::Ciphertext& ciphertext, const int64_t scalar) const
     {
-        seal::Ciphertext destination;
-        sub(ciphertext, plaintext, destination);
-        return destination;
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        // An integer constant encoded with scale 1 leaves the scale of the ciphertext unchanged.
+        seal::Plaintext plain(memory_pool());
+        ckks_encoder_->encode(scalar, ciphertext.parms_id(), plain);
+        evaluator_->multiply_plain_inplace(ciphertext, plain, memory_pool());
     }
 
-    void FHE::multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const 
+    void FHE::post_multiply_inplace(seal::Ciphertext& ciphertext) const
     {
-        auto multiply_cipher = [this](const seal::Ciphertext& cipher1, const seal::Ciphertext& cipher2, seal::Ciphertext& dest) 
+        // Only a product of two ciphertexts has more than two polynomials before relinearization.
+        const bool ciphertext_product = ciphertext.size() > 2;
+
+        if (ciphertext_product)
         {
-            evaluator_->multiply(cipher1, cipher2, dest);
+            evaluator_->relinearize_inplace(ciphertext, relin_keys_, memory_pool());
+        }
 
-            if (dest.size() > 2)
-            {
-                evaluator_->relinearize_inplace(dest, relin_keys_);
-            }
-      
-            if (dest.coeff_modulus_size() > 1)
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // For BGV/BFV schemes, modulus switching is performed after multiplication according to the policy.
+            policy_mod_switch_inplace(ciphertext, ciphertext_product);
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            if (ciphertext.coeff_modulus_size() > 1)
             {
-                if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
-                {
-                    // For BGV/BFV schemes, modulus switching is performed after multiplication. Modulus size decreases after switching.
-                    evaluator_->mod_switch_to_next_inplace(dest);
-                }
-                else if (scheme_ == seal::scheme_type::ckks)
+                // For CKKS schemes, rescaling is performed after multiplication. Both modulus size and scale decrease after rescaling.
+                evaluator_->rescale_to_next_inplace(ciphertext, memory_pool());
+
+                // A scale that differs from the level scale only by floating-point rounding is snapped to it,
+                // so that ciphertexts at the same level compare equal on the fast path.
+                const double_t target_scale = level_scales_[context_->get_context_data(ciphertext.parms_id())->chain_index()];
+                if (std::fabs(ciphertext.scale() - target_scale) <= target_scale * 64 * std::numeric_limits<double_t>::epsilon())
                 {
-                    // For CKKS schemes, rescaling is performed after multiplication. Both modulus size and scale decrease after rescaling.
-                    evaluator_->rescale_to_next_inplace(dest);
+                    ciphertext.scale() = target_scale;
                 }
             }
-        };
+        }
+    }
 
-        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+    void FHE::policy_mod_switch_inplace(seal::Ciphertext& ciphertext, const bool ciphertext_product) const
+    {
+        switch (mod_switch_policy_)
         {
-            // For BGV/BFV schemes, modulus sizes of the ciphertexts must match before multiplication.
-            if (mod_compare(ciphertext1, ciphertext2)) {
-                multiply_cipher(ciphertext1, ciphertext2, destination);
-            }
-            else 
+        case mod_switch_policy_t::eager:
+        {
+            // Modulus size decreases after switching.
+            if (ciphertext.coeff_modulus_size() > 1)
             {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
-
-                mod_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                multiply_cipher(cipher1, cipher2, destination);
+                evaluator_->mod_switch_to_next_inplace(ciphertext, memory_pool());
             }
+            break;
         }
-        else if (scheme_ == seal::scheme_type::ckks)
+        case mod_switch_policy_t::never:
         {
-            // For CKKS schemes, modulus sizes and scales must match before multiplication.
-            if (mod_scale_compare(ciphertext1, ciphertext2))
+            break;
+        }
+        case mod_switch_policy_t::noise_budget:
+        {
+            // Switching never restores budget, so skipping it is always safe. Plaintext products, such as the
+            // internal mask multiplications, are left to the next ciphertext product to save their decryptions.
+            if (!ciphertext_product)
+            {
+                break;
+            }
+
+            // Switching divides the noise by the dropped prime and adds rounding noise of about t * N, so it costs
+            // no budget while the budget stays below log2(q' / t) - log2(N) for the smaller modulus q'. The budget
+            // is measured once and the target level is found from the prime sizes alone.
+            const int32_t noise_budget = decryptor_->invariant_noise_budget(ciphertext);
+
+            auto context_data = context_->get_context_data(ciphertext.parms_id());
+            const int32_t rounding_bits = context_data->parms().plain_modulus().bit_count() +
+                seal::util::get_power_of_two(context_data->parms().poly_modulus_degree());
+
+            while (context_data->next_context_data())
             {
-                multiply_cipher(ciphertext1, ciphertext2, destination);
+                const int32_t switched_bits = context_data->total_coeff_modulus_bit_count() - context_data->parms().coeff_modulus().back().bit_count();
+                if (noise_budget > switched_bits - rounding_bits)
+                {
+                    break;
+                }
+
+                context_data = context_data->next_context_data();
+            }
+
+            if (context_data->parms_id() != ciphertext.parms_id())
+            {
+                evaluator_->mod_switch_to_inplace(ciphertext, context_data->parms_id(), memory_pool());
             }
-            else 
+            break;
+        }
+        case mod_switch_policy_t::fixed_level:
+        {
+            if (ciphertext.coeff_modulus_size() > mod_switch_level_)
             {
-                seal::Ciphertext cipher1;
-                seal::Ciphertext cipher2;
+                auto context_data = context_->get_context_data(ciphertext.parms_id());
+                while (context_data->next_context_data() && context_data->parms().coeff_modulus().size() > mod_switch_level_)
+                {
+                    context_data = context_data->next_context_data();
+                }
 
-                mod_scale_matching(ciphertext1, ciphertext2, cipher1, cipher2);
-                multiply_cipher(cipher1, cipher2, destination);
+                evaluator_->mod_switch_to_inplace(ciphertext, context_data->parms_id(), memory_pool());
             }
+            break;
+        }
+        default:
+            throw std::invalid_argument("The specified modulus switching policy is not defined.");
+            break;
         }
     }
 
-    seal::Ciphertext FHE::multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
+    void FHE::add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const
+    {
+        if (&ciphertext1 == &destination)
+        {
+            add_inplace(destination, ciphertext2);
+        }
+        else if (&ciphertext2 == &destination)
+        {
+            add_inplace(destination, ciphertext1);
+        }
+        else
+        {
+            destination = ciphertext1;
+            add_inplace(destination, ciphertext2);
+        }
+    }
+
+    seal::Ciphertext FHE::add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
     {
         seal::Ciphertext destination;
-        multiply(ciphertext1, ciphertext2, destination);
+        add(ciphertext1, ciphertext2, destination);
         return destination;
     }
 
-    void FHE::multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const 
+    void FHE::add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const
     {
-        auto multiply_plain = [this](const seal::Ciphertext& cipher, const seal::Plaintext& plain, seal::Ciphertext& dest)
+        if (&ciphertext != &destination)
         {
-            evaluator_->multiply_plain(cipher, plain, dest);
+            destination = ciphertext;
+        }
+
+        add_inplace(destination, plaintext);
+    }
+
+    seal::Ciphertext FHE::add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const 
+    {
+        seal::Ciphertext destination;
+        add(ciphertext, plaintext, destination);
+        return destination;
+    }
 
-            if (dest.coeff_modulus_size() > 1)
+    void FHE::add_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
+    {
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // For BGV and BFV schemes, modulus sizes of the two ciphertexts must be matched before addition.
+            if (mod_compare(ciphertext1, ciphertext2))
             {
-                if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
-                {
-                    // For BGV/BFV schemes, modulus switching is performed after multiplication. Modulus size decreases after switching.
-                    evaluator_->mod_switch_to_next_inplace(dest);
-                }
-                else if (scheme_ == seal::scheme_type::ckks)
-                {
-                    // For CKKS schemes, rescaling is performed after multiplication. Both modulus size and scale decrease after rescaling.
-                    evaluator_->rescale_to_next_inplace(dest);
-                }
+                evaluator_->add_inplace(ciphertext1, ciphertext2);
+            }
+            else
+            {
+                seal::Ciphertext buffer(memory_pool());
+                evaluator_->add_inplace(ciphertext1, level_matching(ciphertext1, ciphertext2, buffer));
+            }
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            // For CKKS schemes, modulus sizes and scales of the two ciphertexts must be matched before addition.
+            if (mod_scale_compare(ciphertext1, ciphertext2))
+            {
+                evaluator_->add_inplace(ciphertext1, ciphertext2);
+            }
+            else
+            {
+                seal::Ciphertext buffer(memory_pool());
+                evaluator_->add_inplace(ciphertext1, level_matching(ciphertext1, ciphertext2, buffer));
             }
-        };
-        
+        }
+    }
+
+    void FHE::add_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
+    {
         if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
         {
-            // For BGV/BFV schemes, modulus switching for the plaintext is not required before multiplication.
-            multiply_plain(ciphertext, plaintext, destination);
+            // For BGV and BFV schemes, modulus switching for plaintext is not required before addition.
+            evaluator_->add_plain_inplace(ciphertext, plaintext, memory_pool());
         }
         else if (scheme_ == seal::scheme_type::ckks)
         {
-            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before multiplication.
+            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before addition.
             if (mod_scale_compare(ciphertext, plaintext))
             {
-                multiply_plain(ciphertext, plaintext, destination);
+                evaluator_->add_plain_inplace(ciphertext, plaintext, memory_pool());
             }
             else
             {
-                seal::Plaintext plain;
+                seal::Plaintext plain(memory_pool());
 
                 mod_scale_matching(ciphertext, plaintext, plain);
-                multiply_plain(ciphertext, plain, destination);
+                evaluator_->add_plain_inplace(ciphertext, plain, memory_pool());
             }
         }
     }
 
-    seal::Ciphertext FHE::multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
+    void FHE::sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const 
+    {
+        if (&ciphertext1 == &destination)
+        {
+            sub_inplace(destination, ciphertext2);
+        }
+        else if (&ciphertext2 == &destination)
+        {
+            // ciphertext1 - ciphertext2 is computed as (-ciphertext2) + ciphertext1 to avoid copying.
+            negate_inplace(destination);
+            add_inplace(destination, ciphertext1);
+        }
+        else
+        {
+            destination = ciphertext1;
+            sub_inplace(destination, ciphertext2);
+        }
+    }
+
+    seal::Ciphertext FHE::sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const 
     {
         seal::Ciphertext destination;
-        multiply(ciphertext, plaintext, destination);
+        sub(ciphertext1, ciphertext2, destination);
         return destination;
     }
 
-    void FHE::negate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const
+    void FHE::sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const 
     {
-        evaluator_->negate(ciphertext, destination);
+        if (&ciphertext != &destination)
+        {
+            destination = ciphertext;
+        }
+
+        sub_inplace(destination, plaintext);
     }
 
-    seal::Ciphertext FHE::negate(const seal::Ciphertext& ciphertext) const
+    seal::Ciphertext FHE::sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const 
     {
         seal::Ciphertext destination;
-        negate(ciphertext, destination);
+        sub(ciphertext, plaintext, destination);
         return destination;
     }
 
-    void FHE::rotate_rows(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const 
+    void FHE::sub_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
     {
-        // Verify scheme.
-        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
         {
-            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+            // For BGV and BFV schemes, modulus sizes of the two ciphertexts must be matched before subtraction.
+            if (mod_compare(ciphertext1, ciphertext2))
+            {
+                evaluator_->sub_inplace(ciphertext1, ciphertext2);
+            }
+            else
+            {
+                seal::Ciphertext buffer(memory_pool());
+                evaluator_->sub_inplace(ciphertext1, level_matching(ciphertext1, ciphertext2, buffer));
+            }
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            // For CKKS schemes, modulus sizes and scales of the two ciphertexts must be matched before subtraction.
+            if (mod_scale_compare(ciphertext1, ciphertext2))
+            {
+                evaluator_->sub_inplace(ciphertext1, ciphertext2);
+            }
+            else
+            {
+                seal::Ciphertext buffer(memory_pool());
+                evaluator_->sub_inplace(ciphertext1, level_matching(ciphertext1, ciphertext2, buffer));
+            }
+        }
+    }
+
+    void FHE::sub_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
+    {
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // For BGV and BFV schemes, modulus switching for plaintext is not required before subtraction.
+            evaluator_->sub_plain_inplace(ciphertext, plaintext, memory_pool());
         }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before subtraction.
+            if (mod_scale_compare(ciphertext, plaintext))
+            {
+                evaluator_->sub_plain_inplace(ciphertext, plaintext, memory_pool());
+            }
+            else
+            {
+                seal::Plaintext plain(memory_pool());
 
-        evaluator_->rotate_rows(ciphertext, step, galois_keys_, destination);
+                mod_scale_matching(ciphertext, plaintext, plain);
+                evaluator_->sub_plain_inplace(ciphertext, plain, memory_pool());
+            }
+        }
     }
 
-    seal::Ciphertext FHE::rotate_rows(const seal::Ciphertext& ciphertext, const int32_t step) const
+    void FHE::multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const 
+    {
+        if (&ciphertext1 == &destination)
+        {
+            multiply_inplace(destination, ciphertext2);
+        }
+        else if (&ciphertext2 == &destination)
+        {
+            multiply_inplace(destination, ciphertext1);
+        }
+        else
+        {
+            destination = ciphertext1;
+            multiply_inplace(destination, ciphertext2);
+        }
+    }
+
+    seal::Ciphertext FHE::multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
     {
         seal::Ciphertext destination;
-        rotate_rows(ciphertext, step, destination);
+        multiply(ciphertext1, ciphertext2, destination);
         return destination;
     }
 
-    void FHE::rotate_columns(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const 
+    void FHE::multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const 
     {
-        // Verify scheme.
-        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        if (&ciphertext != &destination)
         {
-            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+            destination = ciphertext;
         }
 
-        evaluator_->rotate_columns(ciphertext, galois_keys_, destination);
+        multiply_inplace(destination, plaintext);
     }
 
-    seal::Ciphertext FHE::rotate_columns(const seal::Ciphertext& ciphertext) const 
+    seal::Ciphertext FHE::multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
     {
         seal::Ciphertext destination;
-        rotate_columns(ciphertext, destination);
+        multiply(ciphertext, plaintext, destination);
         return destination;
     }
 
-    void FHE::row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const 
+    void FHE::multiply_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
     {
-        // Verify scheme.
-        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        seal::Ciphertext buffer(memory_pool());
+        const seal::Ciphertext* operand = &ciphertext2;
+
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
         {
-            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+            // For BGV/BFV schemes, modulus sizes of the ciphertexts must match before multiplication.
+            if (!mod_compare(ciphertext1, ciphertext2))
+            {
+                operand = &level_matching(ciphertext1, ciphertext2, buffer);
+            }
         }
-
-        const int32_t half_slot_count = static_cast<int32_t>(batch_encoder_->slot_count()) / 2;
-        const int32_t logn = seal::util::get_power_of_two(static_cast<uint64_t>(range_size));
-
-        if (range_size < 2 || range_size > half_slot_count)
+        else if (scheme_ == seal::scheme_type::ckks)
         {
-            throw std::invalid_argument("The range size must be between 2 and the half slot count (inclusive).");
+            // For CKKS schemes, modulus sizes and scales must match before multiplication.
+            if (!mod_scale_compare(ciphertext1, ciphertext2))
+            {
+                operand = &level_matching(ciphertext1, ciphertext2, buffer);
+            }
         }
 
-        if (logn == -1) 
+        if (operand == &ciphertext1)
         {
-            throw std::invalid_argument("The range size must be a power of 2.");
+            // Both operands are the same object, so squaring is used to avoid aliasing.
+            evaluator_->square_inplace(ciphertext1, memory_pool());
+        }
+        else
+        {
+            evaluator_->multiply_inplace(ciphertext1, *operand, memory_pool());
         }
 
-        destination = ciphertext;
-        seal::Ciphertext rotated;
+        post_multiply_inplace(ciphertext1);
+    }
 
-        for (int32_t i = 0, step = 1; i < logn; i++, step <<= 1) 
+    void FHE::add_many(const std::vector<seal::Ciphertext>& ciphertexts, seal::Ciphertext& destination) const
+    {
+        if (ciphertexts.empty())
         {
-            rotate_rows(destination, step, rotated);
-            add(destination, rotated, destination);
+            throw std::invalid_argument("The ciphertext vector must not be empty.");
         }
+
+        std::vector<seal::Ciphertext> buffers;
+        std::vector<const seal::Ciphertext*> aligned;
+        level_matching_many(ciphertexts, buffers, aligned);
+
+        // All terms are already aligned, so the evaluator is called directly.
+        tree_reduce(aligned, destination, [this](seal::Ciphertext& cipher1, const seal::Ciphertext& cipher2)
+        {
+            evaluator_->add_inplace(cipher1, cipher2);
+        });
+
+        release_all(buffers);
     }
 
-    seal::Ciphertext FHE::row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const 
+    seal::Ciphertext FHE::add_many(const std::vector<seal::Ciphertext>& ciphertexts) const
     {
         seal::Ciphertext destination;
-        row_sum(ciphertext, range_size, destination);
+        add_many(ciphertexts, destination);
         return destination;
     }
 
-    void FHE::column_sum(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const 
+    void FHE::multiply_many(const std::vector<seal::Ciphertext>& ciphertexts, seal::Ciphertext& destination) const
     {
-        // Verify scheme.
-        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        if (ciphertexts.empty())
         {
-            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+            throw std::invalid_argument("The ciphertext vector must not be empty.");
         }
 
-        seal::Ciphertext rotated;
-        rotate_columns(ciphertext, rotated);
-        add(ciphertext, rotated, destination);
+        std::vector<seal::Ciphertext> buffers;
+        std::vector<const seal::Ciphertext*> aligned;
+        level_matching_many(ciphertexts, buffers, aligned);
+
+        // Terms of one round stay at the same level; a term carried over from an odd round is matched by `multiply_inplace`.
+        tree_reduce(aligned, destination, [this](seal::Ciphertext& cipher1, const seal::Ciphertext& cipher2)
+        {
+            multiply_inplace(cipher1, cipher2);
+        });
+
+        release_all(buffers);
     }
 
-    seal::Ciphertext FHE::column_sum(const seal::Ciphertext& ciphertext) const 
+    seal::Ciphertext FHE::multiply_many(const std::vector<seal::Ciphertext>& ciphertexts) const
     {
         seal::Ciphertext destination;
-        column_sum(ciphertext, destination);
+        multiply_many(ciphertexts, destination);
+        return destination;
+    }
+
+    void FHE::tree_reduce(const std::vector<const seal::Ciphertext*>& aligned, seal::Ciphertext& destination, const std::function<void(seal::Ciphertext&, const seal::Ciphertext&)>& combine) const
+    {
+        const size_t count = aligned.size();
+
+        // The first round reads the inputs directly, so each pair costs a single copy.
+        std::vector<seal::Ciphertext> terms((count + 1) / 2);
+        parallel_for(terms.size(), [&](size_t i)
+        {
+            // The first term becomes the result; the others are scratch buffers from the free list.
+            if (i > 0)
+            {
+                terms[i] = acquire_ciphertext(aligned[2 * i]->parms_id());
+            }
+
+            terms[i] = *aligned[2 * i];
+            if (2 * i + 1 < count)
+            {
+                combine(terms[i], *aligned[2 * i + 1]);
+            }
+        });
+
+        // Each following round combines the lower half with the upper half; the middle term of an odd round is carried over.
+        for (size_t size = terms.size(); size > 1; )
+        {
+            const size_t half = size / 2;
+            const size_t upper = size - half;
+
+            parallel_for(half, [&](size_t i)
+            {
+                combine(terms[i], terms[upper + i]);
+            });
+
+            size = upper;
+        }
+
+        destination = std::move(terms[0]);
+        release_all(terms);
+    }
+
+    void FHE::square(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const
+    {
+        if (&ciphertext != &destination)
+        {
+            destination = ciphertext;
+        }
+
+        square_inplace(destination);
+    }
+
+    seal::Ciphertext FHE::square(const seal::Ciphertext& ciphertext) const
+    {
+        seal::Ciphertext destination;
+        square(ciphertext, destination);
+        return destination;
+    }
+
+    void FHE::square_inplace(seal::Ciphertext& ciphertext) const
+    {
+        // Squaring needs no level matching and is cheaper than a general multiplication.
+        evaluator_->square_inplace(ciphertext, memory_pool());
+        post_multiply_inplace(ciphertext);
+    }
+
+    void FHE::power(const seal::Ciphertext& ciphertext, const uint64_t exponent, seal::Ciphertext& destination) const
+    {
+        if (exponent == 0)
+        {
+            throw std::invalid_argument("The exponent must be at least 1.");
+        }
+
+        // Collect x^(2^i) for every set bit of the exponent together with its multiplicative depth.
+        std::vector<std::pair<int32_t, seal::Ciphertext>> terms;
+        seal::Ciphertext squared = ciphertext;
+
+        for (int32_t depth = 0; ; depth++)
+        {
+            if ((exponent >> depth) & 1)
+            {
+                terms.emplace_back(depth, squared);
+            }
+
+            if (depth == 63 || (exponent >> (depth + 1)) == 0)
+            {
+                break;
+            }
+
+            square_inplace(squared);
+        }
+
+        // Always combine the two shallowest terms, so the result has depth ceil(log2(exponent)).
+        auto shallower = [](const std::pair<int32_t, seal::Ciphertext>& a, const std::pair<int32_t, seal::Ciphertext>& b) { return a.first > b.first; };
+        std::make_heap(terms.begin(), terms.end(), shallower);
+
+        while (terms.size() > 1)
+        {
+            std::pop_heap(terms.begin(), terms.end(), shallower);
+            std::pair<int32_t, seal::Ciphertext> first = std::move(terms.back());
+            terms.pop_back();
+
+            std::pop_heap(terms.begin(), terms.end(), shallower);
+            std::pair<int32_t, seal::Ciphertext>& second = terms.back();
+
+            multiply_inplace(second.second, first.second);
+            second.first = std::max(first.first, second.first) + 1;
+            std::push_heap(terms.begin(), terms.end(), shallower);
+        }
+
+        destination = std::move(terms.front().second);
+    }
+
+    seal::Ciphertext FHE::power(const seal::Ciphertext& ciphertext, const uint64_t exponent) const
+    {
+        seal::Ciphertext destination;
+        power(ciphertext, exponent, destination);
+        return destination;
+    }
+
+    void FHE::multiply_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
+    {
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            // For BGV/BFV schemes, modulus switching for the plaintext is not required before multiplication.
+            evaluator_->multiply_plain_inplace(ciphertext, plaintext, memory_pool());
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            // For CKKS schemes, the modulus size and scale of the plaintext must match the ciphertext before multiplication.
+            if (mod_scale_compare(ciphertext, plaintext))
+            {
+                evaluator_->multiply_plain_inplace(ciphertext, plaintext, memory_pool());
+            }
+            else
+            {
+                seal::Plaintext plain(memory_pool());
+
+                mod_scale_matching(ciphertext, plaintext, plain);
+                evaluator_->multiply_plain_inplace(ciphertext, plain, memory_pool());
+            }
+        }
+
+        post_multiply_inplace(ciphertext);
+    }
+
+    void FHE::transform_to_ntt(const seal::Plaintext& plaintext, const seal::parms_id_type& parms_id, seal::Plaintext& destination) const
+    {
+        if (plaintext.is_ntt_form())
+        {
+            if (plaintext.parms_id() != parms_id)
+            {
+                throw std::invalid_argument("The plaintext is in NTT form at a different level.");
+            }
+
+            destination = plaintext;
+            return;
+        }
+
+        evaluator_->transform_to_ntt(plaintext, parms_id, destination, memory_pool());
+    }
+
+    seal::Plaintext FHE::transform_to_ntt(const seal::Plaintext& plaintext, const seal::parms_id_type& parms_id) const
+    {
+        seal::Plaintext destination;
+        transform_to_ntt(plaintext, parms_id, destination);
+        return destination;
+    }
+
+    void FHE::finish_multiply_inplace(seal::Ciphertext& ciphertext) const
+    {
+        post_multiply_inplace(ciphertext);
+    }
+
+    void FHE::sum_of_products(const std::vector<seal::Ciphertext>& lhs, const std::vector<seal::Ciphertext>& rhs, seal::Ciphertext& destination) const
+    {
+        if (lhs.empty() || lhs.size() != rhs.size())
+        {
+            throw std::invalid_argument("The operand vectors must be non-empty and of equal length.");
+        }
+
+        const size_t count = lhs.size();
+
+        std::vector<const seal::Ciphertext*> operands;
+        operands.reserve(2 * count);
+
+        for (const seal::Ciphertext& ciphertext : lhs) operands.push_back(&ciphertext);
+        for (const seal::Ciphertext& ciphertext : rhs) operands.push_back(&ciphertext);
+
+        // All operands share one level and scale, so the size-3 products can be added directly.
+        std::vector<seal::Ciphertext> buffers;
+        std::vector<const seal::Ciphertext*> aligned;
+        level_matching_many(operands, buffers, aligned);
+
+        // Relinearization is deferred until all products are accumulated.
+        evaluator_->multiply(*aligned[0], *aligned[count], destination, memory_pool());
+
+        seal::Ciphertext product(memory_pool());
+        for (size_t i = 1; i < count; i++)
+        {
+            evaluator_->multiply(*aligned[i], *aligned[count + i], product, memory_pool());
+            evaluator_->add_inplace(destination, product);
+        }
+
+        release_all(buffers);
+        post_multiply_inplace(destination);
+    }
+
+    seal::Ciphertext FHE::sum_of_products(const std::vector<seal::Ciphertext>& lhs, const std::vector<seal::Ciphertext>& rhs) const
+    {
+        seal::Ciphertext destination;
+        sum_of_products(lhs, rhs, destination);
+        return destination;
+    }
+
+    void FHE::multiply_add(seal::Ciphertext& accumulator, const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const
+    {
+        seal::Ciphertext product(memory_pool());
+        seal::Ciphertext buffer(memory_pool());
+
+        product = ciphertext1;
+
+        // Relinearization and rescaling are deferred until `finalize_accumulator`.
+        evaluator_->multiply_inplace(product, level_matching(product, ciphertext2, buffer), memory_pool());
+        accumulate_inplace(accumulator, product);
+    }
+
+    void FHE::multiply_plain_add(seal::Ciphertext& accumulator, const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const
+    {
+        seal::Ciphertext product(memory_pool());
+
+        if (scheme_ == seal::scheme_type::ckks && !mod_scale_compare(ciphertext, plaintext))
+        {
+            seal::Plaintext plain(memory_pool());
+
+            mod_scale_matching(ciphertext, plaintext, plain);
+            evaluator_->multiply_plain(ciphertext, plain, product, memory_pool());
+        }
+        else
+        {
+            evaluator_->multiply_plain(ciphertext, plaintext, product, memory_pool());
+        }
+
+        // Rescaling is deferred until `finalize_accumulator`.
+        accumulate_inplace(accumulator, product);
+    }
+
+    void FHE::finalize_accumulator(seal::Ciphertext& accumulator) const
+    {
+        post_multiply_inplace(accumulator);
+    }
+
+    void FHE::accumulate_inplace(seal::Ciphertext& accumulator, seal::Ciphertext& product) const
+    {
+        if (accumulator.size() == 0)
+        {
+            // A product allocated from the scratch pool is copied, so that the accumulator never takes that pool over.
+            if (product.pool() == accumulator.pool())
+            {
+                accumulator = std::move(product);
+            }
+            else
+            {
+                accumulator = product;
+            }
+            return;
+        }
+
+        if (accumulator.parms_id() != product.parms_id())
+        {
+            if (scheme_ == seal::scheme_type::ckks)
+            {
+                throw std::invalid_argument("The product must match the level and scale of the accumulator.");
+            }
+
+            // For BGV/BFV schemes, the operand with the larger modulus is switched down.
+            if (accumulator.coeff_modulus_size() > product.coeff_modulus_size())
+            {
+                evaluator_->mod_switch_to_inplace(accumulator, product.parms_id(), memory_pool());
+            }
+            else
+            {
+                evaluator_->mod_switch_to_inplace(product, accumulator.parms_id(), memory_pool());
+            }
+        }
+
+        evaluator_->add_inplace(accumulator, product);
+    }
+
+    void FHE::negate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const
+    {
+        evaluator_->negate(ciphertext, destination);
+    }
+
+    seal::Ciphertext FHE::negate(const seal::Ciphertext& ciphertext) const
+    {
+        seal::Ciphertext destination;
+        negate(ciphertext, destination);
+        return destination;
+    }
+
+    void FHE::negate_inplace(seal::Ciphertext& ciphertext) const
+    {
+        evaluator_->negate_inplace(ciphertext);
+    }
+
+    void FHE::rotate_rows(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const 
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        rotate_internal(ciphertext, normalize_step(step), destination);
+    }
+
+    seal::Ciphertext FHE::rotate_rows(const seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        seal::Ciphertext destination;
+        rotate_rows(ciphertext, step, destination);
+        return destination;
+    }
+
+    void FHE::rotate_rows_inplace(seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        rotate_internal(ciphertext, normalize_step(step), ciphertext);
+    }
+
+    void FHE::rotate_columns(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const 
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        evaluator_->rotate_columns(ciphertext, galois_keys_, destination, memory_pool());
+    }
+
+    seal::Ciphertext FHE::rotate_columns(const seal::Ciphertext& ciphertext) const 
+    {
+        seal::Ciphertext destination;
+        rotate_columns(ciphertext, destination);
+        return destination;
+    }
+
+    void FHE::rotate_columns_inplace(seal::Ciphertext& ciphertext) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        evaluator_->rotate_columns_inplace(ciphertext, galois_keys_, memory_pool());
+    }
+
+    void FHE::row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const 
+    {
+        destination = ciphertext;
+        row_sum_inplace(destination, range_size);
+    }
+
+    seal::Ciphertext FHE::row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const 
+    {
+        seal::Ciphertext destination;
+        row_sum(ciphertext, range_size, destination);
+        return destination;
+    }
+
+    void FHE::row_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        const int32_t half_slot_count = static_cast<int32_t>(batch_encoder_->slot_count()) / 2;
+
+        if (range_size < 1 || range_size > half_slot_count)
+        {
+            throw std::invalid_argument("The range size must be between 1 and the half slot count (inclusive).");
+        }
+
+        sliding_sum_inplace(ciphertext, range_size, 1);
+    }
+
+    void FHE::column_sum(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const 
+    {
+        destination = ciphertext;
+        column_sum_inplace(destination);
+    }
+
+    seal::Ciphertext FHE::column_sum(const seal::Ciphertext& ciphertext) const 
+    {
+        seal::Ciphertext destination;
+        column_sum(ciphertext, destination);
+        return destination;
+    }
+
+    void FHE::column_sum_inplace(seal::Ciphertext& ciphertext) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv))
+        {
+            throw std::invalid_argument("This function is only supported for BGV and BFV schemes.");
+        }
+
+        seal::Ciphertext rotated(memory_pool());
+        rotate_columns(ciphertext, rotated);
+        add_inplace(ciphertext, rotated);
+    }
+
+    void FHE::rotate_vector(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        rotate_internal(ciphertext, normalize_step(step), destination);
+    }
+
+    seal::Ciphertext FHE::rotate_vector(const seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        seal::Ciphertext destination;
+        rotate_vector(ciphertext, step, destination);
+        return destination;
+    }
+
+    void FHE::rotate_vector_inplace(seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        rotate_internal(ciphertext, normalize_step(step), ciphertext);
+    }
+
+    void FHE::complex_conjugate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        evaluator_->complex_conjugate(ciphertext, galois_keys_, destination, memory_pool());
+    }
+
+    seal::Ciphertext FHE::complex_conjugate(const seal::Ciphertext& ciphertext) const
+    {
+        seal::Ciphertext destination;
+        complex_conjugate(ciphertext, destination);
+        return destination;
+    }
+
+    void FHE::complex_conjugate_inplace(seal::Ciphertext& ciphertext) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        evaluator_->complex_conjugate_inplace(ciphertext, galois_keys_, memory_pool());
+    }
+
+    void FHE::slot_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        slot_sum_inplace(destination, range_size);
+    }
+
+    seal::Ciphertext FHE::slot_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const
+    {
+        seal::Ciphertext destination;
+        slot_sum(ciphertext, range_size, destination);
+        return destination;
+    }
+
+    void FHE::slot_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        const int32_t slot_count = static_cast<int32_t>(ckks_encoder_->slot_count());
+
+        if (range_size < 1 || range_size > slot_count)
+        {
+            throw std::invalid_argument("The range size must be between 1 and the slot count (inclusive).");
+        }
+
+        sliding_sum_inplace(ciphertext, range_size, 1);
+    }
+
+    void FHE::prefix_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        prefix_sum_inplace(destination, range_size);
+    }
+
+    seal::Ciphertext FHE::prefix_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const
+    {
+        seal::Ciphertext destination;
+        prefix_sum(ciphertext, range_size, destination);
+        return destination;
+    }
+
+    void FHE::prefix_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const
+    {
+        if (range_size < 1 || range_size > row_size())
+        {
+            throw std::invalid_argument("The range size must be between 1 and the row size (inclusive).");
+        }
+
+        seal::Plaintext mask(memory_pool());
+        encode_mask(ciphertext, 0, range_size, mask);
+        multiply_inplace(ciphertext, mask);
+
+        seal::Ciphertext rotated(memory_pool());
+
+        // After the step by 2^k, the nonzero slots span fewer than range_size + 2^(k+1) slots. Up to half a row
+        // that never wraps back into the range, so only the initial mask is needed.
+        const bool masked_steps = range_size > row_size() / 2;
+
+        for (int32_t step = 1; step < range_size; step <<= 1)
+        {
+            rotate_internal(ciphertext, normalize_step(-step), rotated);
+
+            if (masked_steps)
+            {
+                encode_mask(rotated, step, range_size, mask);
+                multiply_inplace(rotated, mask);
+            }
+
+            add_inplace(ciphertext, rotated);
+        }
+    }
+
+    void FHE::window_sum(const seal::Ciphertext& ciphertext, const int32_t window_size, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        window_sum_inplace(destination, window_size);
+    }
+
+    seal::Ciphertext FHE::window_sum(const seal::Ciphertext& ciphertext, const int32_t window_size) const
+    {
+        seal::Ciphertext destination;
+        window_sum(ciphertext, window_size, destination);
+        return destination;
+    }
+
+    void FHE::window_sum_inplace(seal::Ciphertext& ciphertext, const int32_t window_size) const
+    {
+        if (window_size < 1 || window_size > row_size())
+        {
+            throw std::invalid_argument("The window size must be between 1 and the row size (inclusive).");
+        }
+
+        sliding_sum_inplace(ciphertext, window_size, -1);
+    }
+
+    void FHE::broadcast_slot(const seal::Ciphertext& ciphertext, const int32_t index, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        broadcast_slot_inplace(destination, index);
+    }
+
+    seal::Ciphertext FHE::broadcast_slot(const seal::Ciphertext& ciphertext, const int32_t index) const
+    {
+        seal::Ciphertext destination;
+        broadcast_slot(ciphertext, index, destination);
+        return destination;
+    }
+
+    void FHE::broadcast_slot_inplace(seal::Ciphertext& ciphertext, const int32_t index) const
+    {
+        if (index < 0 || static_cast<uint64_t>(index) >= slot_count())
+        {
+            throw std::invalid_argument("The index must be within the slot count.");
+        }
+
+        const int32_t size = row_size();
+        const int32_t row = index / size;
+        const int32_t column = index % size;
+
+        seal::Plaintext mask(memory_pool());
+        encode_mask(ciphertext, column, column + 1, mask, row);
+        multiply_inplace(ciphertext, mask);
+
+        // Only one slot is nonzero, so summing the whole row writes it everywhere.
+        sliding_sum_inplace(ciphertext, size, 1);
+
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            seal::Ciphertext swapped(memory_pool());
+            evaluator_->rotate_columns(ciphertext, galois_keys_, swapped, memory_pool());
+            add_inplace(ciphertext, swapped);
+        }
+    }
+
+    void FHE::extract(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        extract_inplace(destination, begin, size);
+    }
+
+    seal::Ciphertext FHE::extract(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const
+    {
+        seal::Ciphertext destination;
+        extract(ciphertext, begin, size, destination);
+        return destination;
+    }
+
+    void FHE::extract_inplace(seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const
+    {
+        if (begin < 0 || size < 1 || begin + size > row_size())
+        {
+            throw std::invalid_argument("The range must be non-empty and within a row.");
+        }
+
+        mask_range_inplace(ciphertext, begin, size);
+
+        if (begin != 0)
+        {
+            rotate_internal(ciphertext, normalize_step(begin), ciphertext);
+        }
+
+        // The copies do not overlap, so placing them is a sliding sum with a stride of one block.
+        const int32_t copies = row_size() / size;
+        if (copies > 1)
+        {
+            sliding_sum_inplace(ciphertext, copies, -size);
+        }
+    }
+
+    void FHE::rotate(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const
+    {
+        rotate_internal(ciphertext, normalize_step(step), destination);
+    }
+
+    seal::Ciphertext FHE::rotate(const seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        seal::Ciphertext destination;
+        rotate(ciphertext, step, destination);
+        return destination;
+    }
+
+    void FHE::rotate_inplace(seal::Ciphertext& ciphertext, const int32_t step) const
+    {
+        rotate_internal(ciphertext, normalize_step(step), ciphertext);
+    }
+
+    void FHE::mask_range_inplace(seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const
+    {
+        if (begin < 0 || size < 1 || begin + size > row_size())
+        {
+            throw std::invalid_argument("The range must be non-empty and within a row.");
+        }
+
+        seal::Plaintext mask(memory_pool());
+        encode_mask(ciphertext, begin, begin + size, mask);
+        multiply_inplace(ciphertext, mask);
+    }
+
+    void FHE::replicate(const seal::Ciphertext& ciphertext, const int32_t block_size, seal::Ciphertext& destination) const
+    {
+        destination = ciphertext;
+        replicate_inplace(destination, block_size);
+    }
+
+    seal::Ciphertext FHE::replicate(const seal::Ciphertext& ciphertext, const int32_t block_size) const
+    {
+        seal::Ciphertext destination;
+        replicate(ciphertext, block_size, destination);
+        return destination;
+    }
+
+    void FHE::replicate_inplace(seal::Ciphertext& ciphertext, const int32_t block_size) const
+    {
+        if (block_size < 1 || block_size > row_size())
+        {
+            throw std::invalid_argument("The block size must be between 1 and the row size (inclusive).");
+        }
+
+        extract_inplace(ciphertext, 0, block_size);
+    }
+
+    void FHE::rotate_many(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& steps, std::vector<seal::Ciphertext>& destination) const
+    {
+        std::vector<int32_t> normalized(steps.size());
+        std::vector<size_t> direct;
+        std::vector<size_t> derived;
+
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            normalized[i] = normalize_step(steps[i]);
+            (has_rotation_key(normalized[i]) ? direct : derived).push_back(i);
+        }
+
+        destination.resize(steps.size());
+
+        // Steps that have their own key cost a single key switch from the input.
+        parallel_for(direct.size(), [&](size_t k)
+        {
+            const size_t i = direct[k];
+            rotate_internal(ciphertext, normalized[i], destination[i]);
+        });
+
+        // Every other step starts from a finished rotation if the remaining difference has its own key.
+        parallel_for(derived.size(), [&](size_t k)
+        {
+            const size_t i = derived[k];
+
+            for (const size_t j : direct)
+            {
+                const int32_t difference = normalize_step(normalized[i] - normalized[j]);
+                if (difference != 0 && has_rotation_key(difference))
+                {
+                    rotate_internal(destination[j], difference, destination[i]);
+                    return;
+                }
+            }
+
+            rotate_internal(ciphertext, normalized[i], destination[i]);
+        });
+    }
+
+    std::vector<seal::Ciphertext> FHE::rotate_many(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& steps) const
+    {
+        std::vector<seal::Ciphertext> destination;
+        rotate_many(ciphertext, steps, destination);
+        return destination;
+    }
+
+    void FHE::rotate_internal(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const
+    {
+        const int32_t size = row_size();
+
+        if (step == 0)
+        {
+            destination = ciphertext;
+        }
+        else if (!rotation_routes_.empty() && !has_rotation_key(step) && rotation_routes_[(step + size) % size] != 0)
+        {
+            // Walk the shortest chain of keyed steps back from the target step.
+            std::vector<int32_t> route;
+            for (int32_t at = step; at != 0; at = normalize_step(at - route.back()))
+            {
+                route.push_back(rotation_routes_[(at + size) % size]);
+            }
+
+            rotate_keyed(ciphertext, route[0], destination);
+            for (size_t i = 1; i < route.size(); i++)
+            {
+                rotate_keyed(destination, route[i], destination);
+            }
+        }
+        else
+        {
+            rotate_keyed(ciphertext, step, destination);
+        }
+    }
+
+    void FHE::rotate_keyed(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const
+    {
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            evaluator_->rotate_rows(ciphertext, step, galois_keys_, destination, memory_pool());
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            evaluator_->rotate_vector(ciphertext, step, galois_keys_, destination, memory_pool());
+        }
+    }
+
+    int32_t FHE::row_size() const
+    {
+        // Both BGV/BFV rows and the CKKS slot vector hold half of the polynomial modulus degree.
+        return static_cast<int32_t>(context_->first_context_data()->parms().poly_modulus_degree() / 2);
+    }
+
+    void FHE::sliding_sum_inplace(seal::Ciphertext& ciphertext, const int32_t window_size, const int32_t stride) const
+    {
+        const int64_t size = row_size();
+
+        // Write the window size as a sum of signed powers of 2. The rotations issued here must stay in step with
+        // `sliding_sum_steps`, which FHEBuilder uses to choose the Galois keys.
+        const std::vector<int32_t> digits = signed_binary_digits(window_size);
+        const size_t top = digits.size() - 1;
+
+        // blocks[k] holds the sums of 2^k consecutive slots; only the blocks used by a digit are kept.
+        std::vector<seal::Ciphertext> blocks;
+        seal::Ciphertext block = ciphertext;
+        seal::Ciphertext rotated(memory_pool());
+
+        // The top block is moved from `block`, so only the smaller ones stay on the scratch pool.
+        blocks.reserve(digits.size());
+        for (size_t k = 0; k <= top; k++)
+        {
+            blocks.emplace_back(memory_pool());
+        }
+
+        for (size_t k = 0; k <= top; k++)
+        {
+            if (k > 0)
+            {
+                rotate_internal(block, normalize_step(static_cast<int32_t>(stride * (int64_t(1) << (k - 1)) % size)), rotated);
+                add_inplace(block, rotated);
+            }
+
+            if (digits[k] != 0)
+            {
+                blocks[k] = (k == top) ? std::move(block) : block;
+            }
+        }
+
+        // Place the blocks one after another from the largest, which needs no rotation.
+        ciphertext = std::move(blocks[top]);
+        int64_t offset = int64_t(1) << top;
+
+        for (size_t k = top; k-- > 0;)
+        {
+            if (digits[k] > 0)
+            {
+                rotate_internal(blocks[k], normalize_step(static_cast<int32_t>(stride * offset % size)), rotated);
+                add_inplace(ciphertext, rotated);
+                offset += int64_t(1) << k;
+            }
+            else if (digits[k] < 0)
+            {
+                offset -= int64_t(1) << k;
+                rotate_internal(blocks[k], normalize_step(static_cast<int32_t>(stride * offset % size)), rotated);
+                sub_inplace(ciphertext, rotated);
+            }
+        }
+    }
+
+    void FHE::encode_mask(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t end, seal::Plaintext& destination, const int32_t row) const
+    {
+        const int32_t size = row_size();
+
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            std::vector<int64_t> mask(static_cast<size_t>(size) * 2, 0);
+            for (int32_t i = begin; i < end; i++)
+            {
+                if (row != 1) mask[i] = 1;
+                if (row != 0) mask[size + i] = 1;
+            }
+            encode(mask, destination);
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            std::vector<double_t> mask(static_cast<size_t>(size), 0.0);
+            std::fill(mask.begin() + begin, mask.begin() + end, 1.0);
+            encode(mask, destination, ciphertext.parms_id());
+        }
+    }
+
+    int32_t FHE::normalize_step(const int32_t step) const
+    {
+        return normalize_rotation_step(step, row_size());
+    }
+
+    bool FHE::has_rotation_key(const int32_t step) const
+    {
+        if (step == 0)
+        {
+            return true;
+        }
+
+        // Rotation keys are stored by Galois element, so look up the element of this exact step.
+        const uint32_t galois_elt = context_->key_context_data()->galois_tool()->get_elt_from_step(step);
+        return galois_keys_.has_key(galois_elt);
+    }
+
+    void FHE::pack(const std::vector<seal::Ciphertext>& ciphertexts, const int32_t stride, std::vector<seal::Ciphertext>& destination, pack_layout_t& layout) const
+    {
+        if (ciphertexts.empty())
+        {
+            throw std::invalid_argument("The ciphertext vector must not be empty.");
+        }
+
+        if (stride < 1 || row_size() % stride != 0)
+        {
+            throw std::invalid_argument("The stride must divide the row size.");
+        }
+
+        const size_t group_size = static_cast<size_t>(stride);
+        const size_t packed_count = (ciphertexts.size() + group_size - 1) / group_size;
+
+        destination.resize(packed_count);
+
+        parallel_for(packed_count, [&](size_t p)
+        {
+            seal::Plaintext mask(memory_pool());
+            seal::Ciphertext part(memory_pool());
+            const size_t end = std::min(ciphertexts.size(), (p + 1) * group_size);
+
+            for (size_t k = p * group_size; k < end; k++)
+            {
+                const int32_t shift = static_cast<int32_t>(k % group_size);
+
+                // The first ciphertext of a group is written straight into the result, which keeps its own pool.
+                seal::Ciphertext& target = shift == 0 ? destination[p] : part;
+
+                target = ciphertexts[k];
+                encode_stride_mask(target, stride, mask);
+                multiply_inplace(target, mask);
+                rotate_internal(target, normalize_step(-shift), target);
+
+                if (shift != 0)
+                {
+                    add_inplace(destination[p], part);
+                }
+            }
+        });
+
+        layout.count = ciphertexts.size();
+        layout.stride = stride;
+    }
+
+    std::vector<seal::Ciphertext> FHE::pack(const std::vector<seal::Ciphertext>& ciphertexts, const int32_t stride, pack_layout_t& layout) const
+    {
+        std::vector<seal::Ciphertext> destination;
+        pack(ciphertexts, stride, destination, layout);
+        return destination;
+    }
+
+    void FHE::unpack(const std::vector<seal::Ciphertext>& packed, const pack_layout_t& layout, std::vector<seal::Ciphertext>& destination) const
+    {
+        if (layout.stride < 1 || row_size() % layout.stride != 0)
+        {
+            throw std::invalid_argument("The stride must divide the row size.");
+        }
+
+        const size_t group_size = static_cast<size_t>(layout.stride);
+
+        if (layout.count == 0 || packed.size() != (layout.count + group_size - 1) / group_size)
+        {
+            throw std::invalid_argument("The packed ciphertexts do not match the layout.");
+        }
+
+        destination.resize(layout.count);
+
+        parallel_for(layout.count, [&](size_t k)
+        {
+            const int32_t shift = static_cast<int32_t>(k % group_size);
+            seal::Plaintext mask(memory_pool());
+
+            rotate_internal(packed[k / group_size], normalize_step(shift), destination[k]);
+            encode_stride_mask(destination[k], layout.stride, mask);
+            multiply_inplace(destination[k], mask);
+        });
+    }
+
+    std::vector<seal::Ciphertext> FHE::unpack(const std::vector<seal::Ciphertext>& packed, const pack_layout_t& layout) const
+    {
+        std::vector<seal::Ciphertext> destination;
+        unpack(packed, layout, destination);
+        return destination;
+    }
+
+    void FHE::encode_stride_mask(const seal::Ciphertext& ciphertext, const int32_t stride, seal::Plaintext& destination) const
+    {
+        const int32_t size = row_size();
+
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            std::vector<int64_t> mask(static_cast<size_t>(size) * 2, 0);
+            for (int32_t i = 0; i < size; i += stride)
+            {
+                mask[i] = 1;
+                mask[size + i] = 1;
+            }
+            encode(mask, destination);
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            std::vector<double_t> mask(static_cast<size_t>(size), 0.0);
+            for (int32_t i = 0; i < size; i += stride)
+            {
+                mask[i] = 1.0;
+            }
+            encode(mask, destination, ciphertext.parms_id());
+        }
+    }
+
+    void FHE::encode_slot_mask(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& slots, seal::Plaintext& destination) const
+    {
+        const int32_t size = row_size();
+
+        if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+        {
+            std::vector<int64_t> mask(static_cast<size_t>(size) * 2, 0);
+            for (const int32_t i : slots)
+            {
+                mask[i] = 1;
+                mask[size + i] = 1;
+            }
+            encode(mask, destination);
+        }
+        else if (scheme_ == seal::scheme_type::ckks)
+        {
+            std::vector<double_t> mask(static_cast<size_t>(size), 0.0);
+            for (const int32_t i : slots)
+            {
+                mask[i] = 1.0;
+            }
+            encode(mask, destination, ciphertext.parms_id());
+        }
+    }
+
+    void FHE::encode_pair(const std::vector<double_t>& first, const std::vector<double_t>& second, seal::Plaintext& destination) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        // Conjugation only separates the parts when slots are evaluated element-wise.
+        if (mul_mode_ != mul_mode_t::element_wise)
+        {
+            throw std::invalid_argument("This function is only supported for the element-wise multiplication mode.");
+        }
+
+        std::vector<std::complex<double_t>> pair(std::max(first.size(), second.size()));
+        for (size_t i = 0; i < first.size(); i++)
+        {
+            pair[i].real(first[i]);
+        }
+        for (size_t i = 0; i < second.size(); i++)
+        {
+            pair[i].imag(second[i]);
+        }
+
+        encode(pair, destination);
+    }
+
+    seal::Plaintext FHE::encode_pair(const std::vector<double_t>& first, const std::vector<double_t>& second) const
+    {
+        seal::Plaintext destination;
+        encode_pair(first, second, destination);
+        return destination;
+    }
+
+    void FHE::decode_pair(const seal::Plaintext& plaintext, std::vector<double_t>& first, std::vector<double_t>& second) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        if (mul_mode_ != mul_mode_t::element_wise)
+        {
+            throw std::invalid_argument("This function is only supported for the element-wise multiplication mode.");
+        }
+
+        std::vector<std::complex<double_t>> pair;
+        decode(plaintext, pair);
+
+        first.resize(pair.size());
+        second.resize(pair.size());
+        for (size_t i = 0; i < pair.size(); i++)
+        {
+            first[i] = pair[i].real();
+            second[i] = pair[i].imag();
+        }
+    }
+
+    void FHE::separate_pair(const seal::Ciphertext& ciphertext, seal::Ciphertext& first, seal::Ciphertext& second) const
+    {
+        // Verify scheme.
+        if (!(scheme_ == seal::scheme_type::ckks))
+        {
+            throw std::invalid_argument("This function is only supported for CKKS schemes.");
+        }
+
+        if (mul_mode_ != mul_mode_t::element_wise)
+        {
+            throw std::invalid_argument("This function is only supported for the element-wise multiplication mode.");
+        }
+
+        seal::Ciphertext conjugated(memory_pool());
+        seal::Ciphertext real_part;
+        seal::Ciphertext imag_part;
+
+        evaluator_->complex_conjugate(ciphertext, galois_keys_, conjugated, memory_pool());
+
+        // Both halves are computed before writing, since either output may alias the input.
+        evaluator_->add(ciphertext, conjugated, real_part);
+        evaluator_->sub(ciphertext, conjugated, imag_part);
+
+        // Every slot of the monomial X^(N/2) is i, so dividing by i is a multiplication by -X^(N/2). It only
+        // permutes and negates coefficients, so it is applied at scale 1 without a rescale.
+        const auto context_data = context_->get_context_data(ciphertext.parms_id());
+        const std::vector<seal::Modulus>& coeff_modulus = context_data->parms().coeff_modulus();
+        const size_t degree = context_data->parms().poly_modulus_degree();
+
+        seal::Plaintext monomial(memory_pool());
+        monomial.resize(degree * coeff_modulus.size());
+        monomial.set_zero();
+
+        for (size_t j = 0; j < coeff_modulus.size(); j++)
+        {
+            monomial[j * degree + degree / 2] = coeff_modulus[j].value() - 1;
+            seal::util::ntt_negacyclic_harvey(monomial.data() + j * degree, context_data->small_ntt_tables()[j]);
+        }
+
+        monomial.parms_id() = ciphertext.parms_id();
+        monomial.scale() = 1.0;
+        evaluator_->multiply_plain_inplace(imag_part, monomial, memory_pool());
+
+        // Doubling the scale halves the decoded values without touching the level.
+        real_part.scale() *= 2;
+        imag_part.scale() *= 2;
+
+        first = std::move(real_part);
+        second = std::move(imag_part);
+    }
+
+    void FHE::matvec(const diagonal_matrix_t& matrix, const std::vector<seal::Ciphertext>& vector, std::vector<seal::Ciphertext>& destination) const
+    {
+        if (matrix.dimension < 1 || matrix.diagonals.size() != matrix.row_blocks * matrix.column_blocks * static_cast<size_t>(matrix.dimension))
+        {
+            throw std::invalid_argument("The matrix is not encoded.");
+        }
+
+        if (vector.size() != matrix.column_blocks)
+        {
+            throw std::invalid_argument("The number of ciphertexts must match the number of block columns.");
+        }
+
+        const int32_t dimension = matrix.dimension;
+        const int32_t baby_steps = std::min(matrix.baby_steps, dimension);
+        const int32_t giant_steps = (dimension + baby_steps - 1) / baby_steps;
+        const size_t column_blocks = matrix.column_blocks;
+
+        // Replicate every input across the row and rotate it by each baby step; these are shared by all block rows.
+        std::vector<std::vector<seal::Ciphertext>> babies(column_blocks, std::vector<seal::Ciphertext>(baby_steps));
+
+        parallel_for(column_blocks, [&](size_t c)
+        {
+            for (seal::Ciphertext& baby : babies[c])
+            {
+                baby = acquire_ciphertext(vector[c].parms_id());
+            }
+
+            babies[c][0] = vector[c];
+            if (dimension < row_size())
+            {
+                sliding_sum_inplace(babies[c][0], row_size() / dimension, -dimension);
+            }
+
+            for (int32_t b = 1; b < baby_steps; b++)
+            {
+                rotate_internal(babies[c][0], normalize_step(b), babies[c][b]);
+            }
+        });
+
+        destination.resize(matrix.row_blocks);
+
+        parallel_for(matrix.row_blocks, [&](size_t r)
+        {
+            seal::Ciphertext result;
+            seal::Ciphertext inner(memory_pool());
+            seal::Ciphertext product(memory_pool());
+            seal::Plaintext switched(memory_pool());
+            bool has_result = false;
+
+            for (int32_t a = 0; a < giant_steps; a++)
+            {
+                // The first inner sum is built in the result itself, which must not live on the scratch pool.
+                seal::Ciphertext& sum = has_result ? inner : result;
+                bool has_inner = false;
+
+                for (size_t c = 0; c < column_blocks; c++)
+                {
+                    for (int32_t b = 0; b < baby_steps && a * baby_steps + b < dimension; b++)
+                    {
+                        const seal::Plaintext& diagonal = matrix.diagonals[(r * column_blocks + c) * dimension + a * baby_steps + b];
+                        const seal::Ciphertext& rotated = babies[c][b];
+
+                        if (diagonal.coeff_count() == 0)
+                        {
+                            continue;
+                        }
+
+                        seal::Ciphertext& target = has_inner ? product : sum;
+
+                        // For CKKS, a diagonal encoded above the input's level is switched down to it.
+                        if (scheme_ == seal::scheme_type::ckks && diagonal.parms_id() != rotated.parms_id())
+                        {
+                            evaluator_->mod_switch_to(diagonal, rotated.parms_id(), switched);
+                            evaluator_->multiply_plain(rotated, switched, target, memory_pool());
+                        }
+                        else
+                        {
+                            evaluator_->multiply_plain(rotated, diagonal, target, memory_pool());
+                        }
+
+                        if (has_inner)
+                        {
+                            evaluator_->add_inplace(sum, product);
+                        }
+                        else
+                        {
+                            has_inner = true;
+                        }
+                    }
+                }
+
+                if (!has_inner)
+                {
+                    continue;
+                }
+
+                post_multiply_inplace(sum);
+
+                if (a > 0)
+                {
+                    rotate_internal(sum, normalize_step(a * baby_steps), sum);
+                }
+
+                if (has_result)
+                {
+                    add_inplace(result, inner);
+                }
+                else
+                {
+                    has_result = true;
+                }
+            }
+
+            if (!has_result)
+            {
+                // The whole block row is zero.
+                encryptor_->encrypt_zero(vector[0].parms_id(), result, memory_pool());
+                result.scale() = vector[0].scale();
+            }
+
+            destination[r] = std::move(result);
+        });
+
+        for (std::vector<seal::Ciphertext>& row : babies)
+        {
+            release_all(row);
+        }
+    }
+
+    std::vector<seal::Ciphertext> FHE::matvec(const diagonal_matrix_t& matrix, const std::vector<seal::Ciphertext>& vector) const
+    {
+        std::vector<seal::Ciphertext> destination;
+        matvec(matrix, vector, destination);
+        return destination;
+    }
+
+    void FHE::matvec(const diagonal_matrix_t& matrix, const seal::Ciphertext& vector, seal::Ciphertext& destination) const
+    {
+        if (matrix.row_blocks != 1 || matrix.column_blocks != 1)
+        {
+            throw std::invalid_argument("The matrix must fit in one block.");
+        }
+
+        std::vector<seal::Ciphertext> product;
+        matvec(matrix, std::vector<seal::Ciphertext>{ vector }, product);
+        destination = std::move(product[0]);
+    }
+
+    seal::Ciphertext FHE::matvec(const diagonal_matrix_t& matrix, const seal::Ciphertext& vector) const
+    {
+        seal::Ciphertext destination;
+        matvec(matrix, vector, destination);
+        return destination;
+    }
+
+    void FHE::permute(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& source, seal::Ciphertext& destination) const
+    {
+        std::vector<seal::Ciphertext> permuted;
+        permute_many(ciphertext, std::vector<std::vector<int32_t>>{ source }, permuted);
+        destination = std::move(permuted[0]);
+    }
+
+    seal::Ciphertext FHE::permute(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& source) const
+    {
+        seal::Ciphertext destination;
+        permute(ciphertext, source, destination);
+        return destination;
+    }
+
+    void FHE::permute_inplace(seal::Ciphertext& ciphertext, const std::vector<int32_t>& source) const
+    {
+        permute(ciphertext, source, ciphertext);
+    }
+
+    void FHE::permute_many(const seal::Ciphertext& ciphertext, const std::vector<std::vector<int32_t>>& sources, std::vector<seal::Ciphertext>& destination) const
+    {
+        const int32_t size = row_size();
+        std::vector<permutation_plan_t> plans;
+        std::vector<int32_t> baby_steps = { 0 };
+
+        for (const std::vector<int32_t>& source : sources)
+        {
+            plans.push_back(plan_permutation(source, size));
+
+            const permutation_plan_t& plan = plans.back();
+            for (const int32_t offset : plan.offsets)
+            {
+                baby_steps.push_back(normalize_step(plan.stride * (((offset - plan.base) / plan.stride) % plan.baby_steps)));
+            }
+        }
+
+        std::sort(baby_steps.begin(), baby_steps.end());
+        baby_steps.erase(std::unique(baby_steps.begin(), baby_steps.end()), baby_steps.end());
+
+        // Every baby step is rotated once from the input and shared by all permutations.
+        std::vector<seal::Ciphertext> babies(baby_steps.size());
+
+        parallel_for(baby_steps.size(), [&](size_t i)
+        {
+            babies[i] = acquire_ciphertext(ciphertext.parms_id());
+
+            if (baby_steps[i] == 0)
+            {
+                babies[i] = ciphertext;
+            }
+            else
+            {
+                rotate_internal(ciphertext, baby_steps[i], babies[i]);
+            }
+        });
+
+        std::vector<seal::Ciphertext> results(sources.size());
+
+        parallel_for(sources.size(), [&](size_t p)
+        {
+            const std::vector<int32_t>& source = sources[p];
+            const permutation_plan_t& plan = plans[p];
+
+            // The destination slots of each offset.
+            std::vector<std::vector<int32_t>> groups(plan.offsets.size());
+            for (size_t slot = 0; slot < source.size(); slot++)
+            {
+                if (source[slot] >= 0)
+                {
+                    const int32_t offset = normalize_step(source[slot] - static_cast<int32_t>(slot));
+                    const size_t group = static_cast<size_t>(std::lower_bound(plan.offsets.begin(), plan.offsets.end(), offset) - plan.offsets.begin());
+                    groups[group].push_back(static_cast<int32_t>(slot));
+                }
+            }
+
+            seal::Ciphertext result;
+            seal::Ciphertext inner(memory_pool());
+            seal::Ciphertext product(memory_pool());
+            seal::Plaintext mask(memory_pool());
+            bool has_result = false;
+
+            // Offsets are ascending, so the offsets of each giant step are consecutive.
+            for (size_t o = 0; o < plan.offsets.size();)
+            {
+                const int32_t giant_index = ((plan.offsets[o] - plan.base) / plan.stride) / plan.baby_steps;
+                const int64_t giant = plan.base + int64_t(plan.stride) * giant_index * plan.baby_steps;
+
+                // The first inner sum is built in the result itself, which must not live on the scratch pool.
+                seal::Ciphertext& sum = has_result ? inner : result;
+                bool has_inner = false;
+
+                for (; o < plan.offsets.size() && ((plan.offsets[o] - plan.base) / plan.stride) / plan.baby_steps == giant_index; o++)
+                {
+                    const int32_t baby_step = normalize_step(plan.stride * (((plan.offsets[o] - plan.base) / plan.stride) % plan.baby_steps));
+                    const seal::Ciphertext& rotated = babies[std::lower_bound(baby_steps.begin(), baby_steps.end(), baby_step) - baby_steps.begin()];
+
+                    // The giant step rotates left by `giant`, so the mask is placed that far to the right.
+                    std::vector<int32_t> slots;
+                    slots.reserve(groups[o].size());
+                    for (const int32_t slot : groups[o])
+                    {
+                        slots.push_back(static_cast<int32_t>(((slot + giant) % size + size) % size));
+                    }
+
+                    encode_slot_mask(rotated, slots, mask);
+                    evaluator_->multiply_plain(rotated, mask, has_inner ? product : sum, memory_pool());
+
+                    if (has_inner)
+                    {
+                        evaluator_->add_inplace(sum, product);
+                    }
+                    else
+                    {
+                        has_inner = true;
+                    }
+                }
+
+                post_multiply_inplace(sum);
+
+                const int32_t giant_step = normalize_step(static_cast<int32_t>(giant % size));
+                if (giant_step != 0)
+                {
+                    rotate_internal(sum, giant_step, sum);
+                }
+
+                if (has_result)
+                {
+                    add_inplace(result, inner);
+                }
+                else
+                {
+                    has_result = true;
+                }
+            }
+
+            if (!has_result)
+            {
+                // Every slot of the result is zero.
+                encryptor_->encrypt_zero(ciphertext.parms_id(), result, memory_pool());
+                result.scale() = ciphertext.scale();
+            }
+
+            results[p] = std::move(result);
+        });
+
+        release_all(babies);
+
+        destination = std::move(results);
+    }
+
+    std::vector<seal::Ciphertext> FHE::permute_many(const seal::Ciphertext& ciphertext, const std::vector<std::vector<int32_t>>& sources) const
+    {
+        std::vector<seal::Ciphertext> destination;
+        permute_many(ciphertext, sources, destination);
         return destination;
     }
-}
\ No newline at end of file
+}
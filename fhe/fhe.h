@@ -2,12 +2,86 @@
 
 #include "seal/seal.h"
 #include "common.h"
+#include "rotation.h"
+#include "threadpool.h"
 #include <vector>
 #include <complex>
 #include <memory>
+#include <functional>
+#include <map>
+#include <mutex>
 
 namespace fhe
 {
+    /**
+    @struct pack_layout_t
+    Describes how `FHE::pack` merged sparse ciphertexts, so that `FHE::unpack` can restore them.
+
+    @details
+    The useful slots of input `k` are those at multiples of `stride` (in every row for BGV/BFV). They are stored
+    in packed ciphertext `k / stride`, shifted right by `k % stride` slots, so the packed ciphertexts are dense.
+    */
+    struct pack_layout_t
+    {
+        /**
+        Number of ciphertexts that were packed.
+        */
+        size_t count = 0;
+
+        /**
+        Distance between the useful slots of each input ciphertext.
+        */
+        int32_t stride = 1;
+    };
+
+    /**
+    @struct diagonal_matrix_t
+    A plaintext matrix pre-encoded for `FHE::matvec`.
+
+    @details
+    The matrix is split into square blocks of `dimension` slots (a power of 2 up to the row size). Every block
+    is stored as its `dimension` generalized diagonals, where diagonal `j` holds `M[i][(i + j) % dimension]` in
+    slot `i`. The diagonals are pre-rotated for the giant step that applies them, so `matvec` never rotates a
+    plaintext. All-zero diagonals are left empty and skipped.
+    */
+    struct diagonal_matrix_t
+    {
+        /**
+        Number of matrix rows.
+        */
+        size_t rows = 0;
+
+        /**
+        Number of matrix columns.
+        */
+        size_t cols = 0;
+
+        /**
+        Side of a block.
+        */
+        int32_t dimension = 0;
+
+        /**
+        Number of baby steps; the giant steps are multiples of it.
+        */
+        int32_t baby_steps = 0;
+
+        /**
+        Number of blocks along the rows (output ciphertexts).
+        */
+        size_t row_blocks = 0;
+
+        /**
+        Number of blocks along the columns (input ciphertexts).
+        */
+        size_t column_blocks = 0;
+
+        /**
+        Diagonal `j` of block (r, c) is stored at `(r * column_blocks + c) * dimension + j`.
+        */
+        std::vector<seal::Plaintext> diagonals;
+    };
+
     /**
     @class FHE
     A class implementing Fully Homomorphic Encryption (FHE) functionality using Microsoft SEAL.
@@ -22,6 +96,13 @@ namespace fhe
     - Decryptor: Decrypts ciphertexts into plaintexts.
     - Evaluator: Performs arithmetic operations on ciphertexts.
     - Key management: Includes secret, public, relinearization, and Galois keys.
+
+    Thread safety: every const member function may be called concurrently on the same instance from any number
+    of threads, as long as no non-const member function (`route_rotations`, `thread_count(size_t)`, or writes
+    through `mul_mode()`, `mod_switch_policy()`, `mod_switch_level()` and `thread_local_memory_pools()`) runs
+    at the same time. The SEAL components are only used through their thread-safe const interfaces, and the
+    arguments of a call belong to its caller, so distinct threads must not write to the same ciphertext or
+    plaintext. Parallel operations run on the instance's thread pool, which is shared by all calling threads.
     */
     class FHE
     {
@@ -101,6 +182,13 @@ namespace fhe
 
         uint64_t slot_count() const;
 
+        /**
+        Retrieves the number of slots that rotate together: a row (half of the slots) for BGV/BFV and every slot for CKKS.
+
+        @return The row size.
+        */
+        int32_t row_size() const;
+
         void plain_modulus(uint64_t& destination) const;
 
         uint64_t plain_modulus() const; 
@@ -117,6 +205,56 @@ namespace fhe
 
         uint64_t last_coeff_modulus_bit() const;
 
+        /**
+        Retrieves the memory size of the Galois keys in bytes (their uncompressed serialized size).
+
+        @param[out] destination A reference to a variable that will store the size.
+        */
+        void galois_keys_size(size_t& destination) const;
+
+        size_t galois_keys_size() const;
+
+        /**
+        Declares the rotation steps that have their own Galois key, so that other steps are routed through them.
+
+        @details
+        SEAL falls back to power-of-two rotations for a step without a key of its own, which fails when the
+        Galois keys were generated for a custom step set. After this call, such a step is instead performed as the
+        shortest chain of keyed steps. An empty list restores SEAL's own behavior. `FHEBuilder` calls this
+        whenever the keys are generated for specific steps.
+
+        @param[in] key_steps The rotation steps that have a Galois key.
+        */
+        void route_rotations(const std::vector<int32_t>& key_steps);
+
+        /**
+        Sets the number of threads that parallel operations run on, replacing the thread pool.
+
+        @details
+        The pool is started by the first parallel operation, not here or in the constructor.
+        `FHEBuilder` sets this from `FHEBuilder::thread_count`. Must not be called while any other member
+        function is running.
+
+        @param[in] count The number of threads, including the calling thread. If 0, the number of hardware threads is used.
+        */
+        void thread_count(const size_t count);
+
+        /**
+        Retrieves the number of threads that parallel operations run on, including the calling thread.
+        */
+        size_t thread_count() const;
+
+        /**
+        Runs `task(i)` for every i in [0, count) on the thread pool and rethrows the first exception.
+
+        @details
+        The calling thread takes part in the loop, so this can be nested inside another parallel task.
+
+        @param[in] count The number of iterations.
+        @param[in] task The loop body.
+        */
+        void parallel_for(const size_t count, const std::function<void(size_t)>& task) const;
+
         /**
         Computes the primitive root modulo the plain modulus for the given value.
 
@@ -170,6 +308,46 @@ namespace fhe
         */
         double_t scale() const;
 
+        /**
+        Retrieves the scale that ciphertexts at the given level carry in the CKKS scheme.
+
+        @details
+        The first level uses the encoding scale (`scale_`). Every lower level uses the scale that a product
+        of two ciphertexts at the level above has after rescaling, i.e. `s * s / q` where `q` is the prime
+        that is actually dropped. `multiply` keeps its results on these scales, so ciphertexts at the same
+        level carry bit-identical scales and skip `mod_scale_matching`.
+
+        @param[in] parms_id The parameters ID of the level.
+        @param[out] destination A reference to a variable that will store the scale of the level.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        @throws std::invalid_argument If `parms_id` does not belong to a data level.
+        */
+        void level_scale(const seal::parms_id_type& parms_id, double_t& destination) const;
+
+        /**
+        Retrieves the scale that ciphertexts at the given level carry in the CKKS scheme.
+
+        @param[in] parms_id The parameters ID of the level.
+        @return The scale of the level.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        @throws std::invalid_argument If `parms_id` does not belong to a data level.
+        */
+        double_t level_scale(const seal::parms_id_type& parms_id) const;
+
+        /**
+        Retrieves the primes of the coefficient modulus at the given level.
+
+        @param[in] parms_id The parameters ID of the level.
+        @param[out] destination A reference to a vector that will store the primes.
+
+        @throws std::invalid_argument If `parms_id` is not valid for the encryption parameters.
+        */
+        void coeff_modulus(const seal::parms_id_type& parms_id, std::vector<seal::Modulus>& destination) const;
+
+        std::vector<seal::Modulus> coeff_modulus(const seal::parms_id_type& parms_id) const;
+
         /**
         Retrieves a reference to the current multiplication mode (`mul_mode_`).
 
@@ -187,6 +365,93 @@ namespace fhe
         */
         mul_mode_t& mul_mode();
 
+        /**
+        Retrieves a reference to the modulus switching policy (`mod_switch_policy_`) for BGV and BFV multiplication.
+
+        @details
+        The policy decides what happens after every ciphertext or plaintext multiplication:
+        - `eager` switches to the next modulus whenever more than one prime remains.
+        - `never` keeps the current modulus, which suits shallow circuits.
+        - `noise_budget` switches only while doing so does not lower the invariant noise budget, estimated from the
+          measured budget and the bit sizes of the dropped primes. This requires the secret key and costs one
+          decryption (`invariant_noise_budget`) per product of two ciphertexts. Plaintext and constant products
+          never switch, since switching cannot restore budget.
+        - `fixed_level` switches down to `mod_switch_level()` primes, so deep circuits run on a smaller modulus early.
+
+        @return A reference to the modulus switching policy.
+        */
+        mod_switch_policy_t& mod_switch_policy();
+
+        /**
+        Retrieves a reference to the coefficient modulus size targeted by the `fixed_level` modulus switching policy.
+
+        @return A reference to the target coefficient modulus size (number of primes).
+        */
+        size_t& mod_switch_level();
+
+        /**
+        Retrieves a reference to whether SEAL's temporary allocations come from per-thread memory pools.
+
+        @details
+        SEAL allocates the temporaries of every evaluation (key switching buffers, NTT scratch space) from the
+        memory pool passed to it, which is the global, mutex-protected pool by default. With per-thread pools,
+        every thread that evaluates, including the thread pool's workers, allocates from its own pool, so
+        threads do not contend and each pool recycles its blocks once warmed up. Only temporaries use these
+        pools; results are always stored in the caller's ciphertexts, so they can be passed between threads.
+        Each pool keeps its memory until its thread exits. `FHEBuilder` sets this from
+        `FHEBuilder::thread_local_memory_pools`.
+
+        @return A reference to the flag.
+        */
+        bool& thread_local_memory_pools();
+
+        /**
+        Retrieves the memory pool that the calling thread passes to SEAL for temporary allocations.
+
+        @return The thread's own pool if `thread_local_memory_pools()` is set, and the global pool otherwise.
+        */
+        seal::MemoryPoolHandle memory_pool() const;
+
+        /**
+        Hands out a ciphertext buffer from the free list, sized for the given level.
+
+        @details
+        The buffer has room for three polynomials (a product before relinearization), so an operation that
+        writes its result into it with a `destination` overload does not allocate. Buffers come from the
+        global memory pool and can be released from any thread.
+
+        @param[in] parms_id The parameters ID of the level.
+        @return A ciphertext buffer at the given level; its contents are unspecified.
+        */
+        seal::Ciphertext acquire_ciphertext(const seal::parms_id_type& parms_id) const;
+
+        /**
+        Returns a ciphertext buffer to the free list.
+
+        @details
+        Buffers that do not come from the global memory pool, or beyond `4 * thread_count()` per level, are freed.
+
+        @param[in] ciphertext The buffer to recycle. It is left empty.
+        */
+        void release(seal::Ciphertext&& ciphertext) const;
+
+        /**
+        Hands out a plaintext buffer from the free list, large enough for an encoding at the first level.
+
+        @return A plaintext buffer; its contents are unspecified.
+        */
+        seal::Plaintext acquire_plaintext() const;
+
+        /**
+        Returns a plaintext buffer to the free list.
+
+        @details
+        Buffers that do not come from the global memory pool, or beyond `4 * thread_count()`, are freed.
+
+        @param[in] plaintext The buffer to recycle. It is left empty.
+        */
+        void release(seal::Plaintext&& plaintext) const;
+
         /**
         Encodes a vector of values into a plaintext polynomial.
 
@@ -238,6 +503,72 @@ namespace fhe
             encode_internal(vector, destination, mul_mode_, scale, &param_id);
         }
 
+        /**
+        Encodes a vector of values into a plaintext polynomial at the given level of the CKKS scheme.
+
+        @details
+        The plaintext is encoded with the scale of that level (see `level_scale`), so that it matches
+        ciphertexts produced by `multiply` at the same level without re-encoding.
+
+        @tparam T Supported types for encoding (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] vector The input vector to be encoded.
+        @param[out] destination The plaintext polynomial to overwrite with the result.
+        @param[in] param_id The encryption parameters ID to use for the encoding process.
+        @throws std::invalid_argument if the scheme is not CKKS.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode(const std::vector<T>& vector, seal::Plaintext& destination, const seal::parms_id_type param_id) const
+        {
+            encode_internal(vector, destination, mul_mode_, level_scale(param_id), &param_id);
+        }
+
+        /**
+        Encodes values from a caller-owned buffer into a plaintext polynomial.
+
+        @details
+        Behaves like the vector overload, for buffers that are not held in a `std::vector` (for example I/O
+        buffers). Values of the encoder's own type are copied once into a per-thread buffer; other types are
+        converted in the same pass. The per-thread buffers are reused, so this does not allocate once warmed up.
+
+        @tparam T Supported types for encoding (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] values The first value to encode.
+        @param[in] count The number of values, at most the slot count.
+        @param[out] destination The plaintext polynomial to overwrite with the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode(const T* values, const size_t count, seal::Plaintext& destination) const
+        {
+            encode_internal(values, count, destination, mul_mode_, scale_);
+        }
+
+        /**
+        Encodes values from a caller-owned buffer into a plaintext polynomial at the given level of the CKKS scheme.
+
+        @tparam T Supported types for encoding (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] values The first value to encode.
+        @param[in] count The number of values, at most the slot count.
+        @param[out] destination The plaintext polynomial to overwrite with the result.
+        @param[in] param_id The encryption parameters ID to use for the encoding process.
+        @throws std::invalid_argument if the scheme is not CKKS.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode(const T* values, const size_t count, seal::Plaintext& destination, const seal::parms_id_type param_id) const
+        {
+            encode_internal(values, count, destination, mul_mode_, level_scale(param_id), &param_id);
+        }
+
         /**
         Encodes a vector of values into a plaintext polynomial and returns the result.
 
@@ -322,55 +653,214 @@ namespace fhe
         }
 
         /**
-        Encrypts a plaintext into a ciphertext.
+        Decodes the first slots of a plaintext polynomial into a caller-owned buffer.
 
-        @param[in] plain The plaintext to be encrypted.
-        @param[out] destination The ciphertext to store the encryption result.
-        */
-        void encrypt(const seal::Plaintext& plain, seal::Ciphertext& destination) const;
+        @details
+        The encoder decodes into a per-thread buffer, and the requested slots are converted into `destination`
+        in one pass, so this does not allocate once warmed up.
 
-        /**
-        Encrypts a plaintext and returns the resulting ciphertext.
+        @tparam T The type of the decoded values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] plaintext The plaintext polynomial to decode.
+        @param[out] destination The first value to overwrite.
+        @param[in] count The number of slots to decode, at most the slot count.
 
-        @param[in] plain The plaintext to be encrypted.
-        @return A `seal::Ciphertext` containing the encryption result.
+        @throws std::invalid_argument If `count` exceeds the slot count.
         */
-        seal::Ciphertext encrypt(const seal::Plaintext& plain) const;
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decode(const seal::Plaintext& plaintext, T* destination, const size_t count) const
+        {
+            decode_internal(plaintext, destination, count, mul_mode_);
+        }
 
         /**
-        Decrypts a ciphertext into a plaintext.
+        Encodes many vectors on the thread pool.
 
-        @param[in] cipher The ciphertext to be decrypted.
-        @param[out] destination The plaintext to store the decryption result.
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] vectors The vectors to encode.
+        @param[out] destination The plaintexts, in the order of `vectors`.
         */
-        void decrypt(const seal::Ciphertext& cipher, seal::Plaintext& destination) const;
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_batch(const std::vector<std::vector<T>>& vectors, std::vector<seal::Plaintext>& destination) const
+        {
+            std::vector<seal::Plaintext> plaintexts(vectors.size());
+
+            parallel_for(vectors.size(), [&](size_t i)
+            {
+                encode(vectors[i], plaintexts[i]);
+            });
+
+            destination = std::move(plaintexts);
+        }
 
         /**
-        Decrypts a ciphertext and returns the resulting plaintext.
+        Decodes many plaintexts on the thread pool.
 
-        @param[in] cipher The ciphertext to be decrypted.
-        @return A `seal::Plaintext` containing the decryption result.
-        @throws std::invalid_argument if the ciphertext is invalid or decryption fails.
+        @tparam T The type of the decoded values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] plaintexts The plaintexts to decode.
+        @param[out] destination The decoded vectors, in the order of `plaintexts`.
         */
-        seal::Plaintext decrypt(const seal::Ciphertext& cipher) const;
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decode_batch(const std::vector<seal::Plaintext>& plaintexts, std::vector<std::vector<T>>& destination) const
+        {
+            destination.resize(plaintexts.size());
+
+            parallel_for(plaintexts.size(), [&](size_t i)
+            {
+                decode(plaintexts[i], destination[i]);
+            });
+        }
 
         /**
-        Compares the coefficient modulus sizes of two ciphertexts.
+        Encodes and encrypts many vectors on the thread pool.
 
         @details
-        This function checks if the modulus sizes of two ciphertexts are the same.
-        It verifies that the scheme is either BGV or BFV before performing the comparison.
+        Each vector is encoded and encrypted by the same thread, so only one plaintext per thread is alive at a time.
 
-        @param[in] ciphertext1 The first ciphertext to compare.
-        @param[in] ciphertext2 The second ciphertext to compare.
-        @return `true` if the coefficient modulus sizes of both ciphertexts are equal, otherwise `false`.
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] vectors The vectors to encrypt.
+        @param[out] destination The ciphertexts, in the order of `vectors`.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encrypt_batch(const std::vector<std::vector<T>>& vectors, std::vector<seal::Ciphertext>& destination) const
+        {
+            destination.resize(vectors.size());
 
-        @throws std::invalid_argument if the encryption scheme is not BGV or BFV.
+            parallel_for(vectors.size(), [&](size_t i)
+            {
+                seal::Plaintext plain(memory_pool());
+                encode(vectors[i], plain);
+                encrypt(plain, destination[i]);
+            });
+        }
+
+        /**
+        Encodes and encrypts many vectors on the thread pool and returns the ciphertexts.
+
+        @tparam T The type of the values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] vectors The vectors to encrypt.
+        @return The ciphertexts, in the order of `vectors`.
         */
-        bool mod_compare(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >std::vector<seal::Ciphertext> encrypt_batch(const std::vector<std::vector<T>>& vectors) const
+        {
+            std::vector<seal::Ciphertext> destination;
+            encrypt_batch(vectors, destination);
+            return destination;
+        }
 
         /**
-        Matches the coefficient modulus sizes of two ciphertexts.
+        Decrypts and decodes many ciphertexts on the thread pool.
+
+        @tparam T The type of the decoded values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertexts The ciphertexts to decrypt.
+        @param[out] destination The decoded vectors, in the order of `ciphertexts`.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decrypt_decode_batch(const std::vector<seal::Ciphertext>& ciphertexts, std::vector<std::vector<T>>& destination) const
+        {
+            destination.resize(ciphertexts.size());
+
+            parallel_for(ciphertexts.size(), [&](size_t i)
+            {
+                seal::Plaintext plain(memory_pool());
+                decrypt(ciphertexts[i], plain);
+                decode(plain, destination[i]);
+            });
+        }
+
+        /**
+        Decrypts and decodes many ciphertexts on the thread pool and returns the vectors.
+
+        @tparam T The type of the decoded values (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertexts The ciphertexts to decrypt.
+        @return The decoded vectors, in the order of `ciphertexts`.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >std::vector<std::vector<T>> decrypt_decode_batch(const std::vector<seal::Ciphertext>& ciphertexts) const
+        {
+            std::vector<std::vector<T>> destination;
+            decrypt_decode_batch(ciphertexts, destination);
+            return destination;
+        }
+
+        /**
+        Encrypts a plaintext into a ciphertext.
+
+        @param[in] plain The plaintext to be encrypted.
+        @param[out] destination The ciphertext to store the encryption result.
+        */
+        void encrypt(const seal::Plaintext& plain, seal::Ciphertext& destination) const;
+
+        /**
+        Encrypts a plaintext and returns the resulting ciphertext.
+
+        @param[in] plain The plaintext to be encrypted.
+        @return A `seal::Ciphertext` containing the encryption result.
+        */
+        seal::Ciphertext encrypt(const seal::Plaintext& plain) const;
+
+        /**
+        Decrypts a ciphertext into a plaintext.
+
+        @param[in] cipher The ciphertext to be decrypted.
+        @param[out] destination The plaintext to store the decryption result.
+        */
+        void decrypt(const seal::Ciphertext& cipher, seal::Plaintext& destination) const;
+
+        /**
+        Decrypts a ciphertext and returns the resulting plaintext.
+
+        @param[in] cipher The ciphertext to be decrypted.
+        @return A `seal::Plaintext` containing the decryption result.
+        @throws std::invalid_argument if the ciphertext is invalid or decryption fails.
+        */
+        seal::Plaintext decrypt(const seal::Ciphertext& cipher) const;
+
+        /**
+        Compares the coefficient modulus sizes of two ciphertexts.
+
+        @details
+        This function checks if the modulus sizes of two ciphertexts are the same.
+        It verifies that the scheme is either BGV or BFV before performing the comparison.
+
+        @param[in] ciphertext1 The first ciphertext to compare.
+        @param[in] ciphertext2 The second ciphertext to compare.
+        @return `true` if the coefficient modulus sizes of both ciphertexts are equal, otherwise `false`.
+
+        @throws std::invalid_argument if the encryption scheme is not BGV or BFV.
+        */
+        bool mod_compare(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
+
+        /**
+        Matches the coefficient modulus sizes of two ciphertexts.
 
         @details
         This function modifies the coefficient modulus sizes of the input ciphertexts
@@ -424,9 +914,9 @@ namespace fhe
 
         @details
         This function adjusts the modulus size and scale of two ciphertexts to make them equal.
-        If they are already equal, an exception is thrown. The function modifies the ciphertext with
-        the larger modulus size by rescaling it using multiplication with a plaintext value of 1
-        and subsequent modulus switching.
+        If they are already equal, an exception is thrown. The ciphertext with the larger modulus size
+        is modulus switched to the other one. If the scales differ, the correction is folded into a single
+        multiplication by a constant and one rescale; when both are at the same level, both drop one level.
 
         @param[in] ciphertext1 The first ciphertext to adjust.
         @param[in] ciphertext2 The second ciphertext to adjust.
@@ -456,247 +946,1683 @@ namespace fhe
         */
         void mod_scale_matching(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Plaintext& destination) const;
 
+        /**
+        Matches the coefficient modulus sizes of two ciphertexts in place.
+
+        @details
+        Only the ciphertext with the larger modulus is modified; it is switched directly to the
+        parameters of the other one. Neither ciphertext is copied.
+
+        @param[in,out] ciphertext1 The first ciphertext to adjust.
+        @param[in,out] ciphertext2 The second ciphertext to adjust.
+
+        @throws std::invalid_argument if the scheme is not BGV or BFV.
+        @throws std::invalid_argument if the modulus sizes are already equal.
+        */
+        void mod_matching_inplace(seal::Ciphertext& ciphertext1, seal::Ciphertext& ciphertext2) const;
+
+        /**
+        Matches the modulus sizes and scales of two ciphertexts in place.
+
+        @details
+        If the modulus sizes differ, only the ciphertext with the larger modulus size is modified; it is
+        brought down to the level and scale of the other one. If they are at the same level but their scales
+        differ, both ciphertexts are modified: a scale can only be corrected while dropping a level, so both
+        drop one level, which costs a level of the circuit. Neither ciphertext is copied.
+
+        @param[in,out] ciphertext1 The first ciphertext to adjust.
+        @param[in,out] ciphertext2 The second ciphertext to adjust.
+
+        @throws std::invalid_argument if the scheme is not CKKS.
+        @throws std::invalid_argument if the modulus sizes and scales are already equal.
+        @throws std::invalid_argument if the scales differ at the same level and no level is left to drop.
+        */
+        void mod_scale_matching_inplace(seal::Ciphertext& ciphertext1, seal::Ciphertext& ciphertext2) const;
+
         // Arithmetic operations: Addition
         void add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const;
         seal::Ciphertext add(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
         void add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const;
         seal::Ciphertext add(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
+        void add_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
+        void add_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
 
         // Arithmetic operations: Subtraction
         void sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const;
         seal::Ciphertext sub(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
         void sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const;
         seal::Ciphertext sub(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
+        void sub_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
+        void sub_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
 
         // Arithmetic operations: Multiplication
         void multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2, seal::Ciphertext& destination) const;
         seal::Ciphertext multiply(const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
         void multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext, seal::Ciphertext& destination) const;
         seal::Ciphertext multiply(const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
-
-        // Negation
-        void negate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
-        seal::Ciphertext negate(const seal::Ciphertext& ciphertext) const;
+        void multiply_inplace(seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
+        void multiply_inplace(seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
 
         /**
-        Rotates the rows of the ciphertext by a specified step.
+        Transforms a plaintext into NTT form at the given level, as it is used for multiplying ciphertexts in NTT form.
 
         @details
-        Row rotation is a slot-wise operation where elements within the ciphertext matrix are shifted
-        by the specified `step`. This function requires Galois keys to be pre-generated and accessible
-        via `galois_keys_`.
+        A plaintext that is already in NTT form at the given level (every CKKS plaintext encoded at that level) is copied.
+        The transformed plaintext can be multiplied into many ciphertexts without transforming it again, e.g. by
+        `CiphertextBatch::multiply`.
 
-        @param[in] ciphertext The input ciphertext to rotate.
-        @param[in] step The number of slots to rotate the rows. Positive for right, negative for left.
-        @param[out] destination The ciphertext containing the rotated result.
+        @param[in] plaintext The plaintext to transform.
+        @param[in] parms_id The parameters ID of the level.
+        @param[out] destination The plaintext to store the result.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @throws std::invalid_argument If the plaintext is in NTT form at a different level.
         */
-        void rotate_rows(const seal::Ciphertext& ciphertext, const int step, seal::Ciphertext& destination) const;
+        void transform_to_ntt(const seal::Plaintext& plaintext, const seal::parms_id_type& parms_id, seal::Plaintext& destination) const;
+
+        seal::Plaintext transform_to_ntt(const seal::Plaintext& plaintext, const seal::parms_id_type& parms_id) const;
 
         /**
-        Rotates the rows of the ciphertext by a specified step and returns the result.
+        Finishes a product that was computed outside this class, exactly as `multiply` finishes its own.
 
         @details
-        This overload provides a simplified interface for row rotation by internally managing the destination ciphertext.
+        Relinearizes the ciphertext if its size exceeds 2, then performs modulus switching according to
+        `mod_switch_policy()` (BGV/BFV) or rescaling (CKKS) while more than one prime remains.
 
-        @param[in] ciphertext The input ciphertext to rotate.
-        @param[in] step The number of slots to rotate the rows. Positive for right, negative for left.
-        @return A new ciphertext containing the rotated result.
+        @param[in] ciphertext The product to finish in place.
+        */
+        void finish_multiply_inplace(seal::Ciphertext& ciphertext) const;
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        /**
+        Adds many ciphertexts in a balanced tree.
+
+        @details
+        All inputs are aligned to a common level (and scale for CKKS) once, before any addition.
+        The additions of each tree round are independent and run on all hardware threads.
+
+        @param[in] ciphertexts The ciphertexts to add. Must not be empty.
+        @param[out] destination The ciphertext containing the sum.
+
+        @throws std::invalid_argument If `ciphertexts` is empty.
         */
-        seal::Ciphertext rotate_rows(const seal::Ciphertext& ciphertext, const int step) const;
+        void add_many(const std::vector<seal::Ciphertext>& ciphertexts, seal::Ciphertext& destination) const;
 
         /**
-        Rotates the columns of the ciphertext.
+        Adds many ciphertexts in a balanced tree and returns the result.
 
-        @param[in] ciphertext The input ciphertext to rotate.
-        @param[out] destination The ciphertext containing the rotated result.
+        @param[in] ciphertexts The ciphertexts to add. Must not be empty.
+        @return A new ciphertext containing the sum.
+
+        @throws std::invalid_argument If `ciphertexts` is empty.
+        */
+        seal::Ciphertext add_many(const std::vector<seal::Ciphertext>& ciphertexts) const;
+
+        /**
+        Multiplies many ciphertexts in a balanced tree.
 
         @details
-        Column rotation is a global permutation of slots in the ciphertext, essentially swapping the left and right halves of the matrix representation.
-        This operation requires Galois keys to be pre-generated and accessible via `galois_keys_`.
+        All inputs are aligned to a common level (and scale for CKKS) once, before any multiplication.
+        The product has multiplicative depth `ceil(log2(n))` instead of `n - 1`, and the multiplications
+        of each tree round are independent and run on all hardware threads.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @param[in] ciphertexts The ciphertexts to multiply. Must not be empty.
+        @param[out] destination The ciphertext containing the product.
+
+        @throws std::invalid_argument If `ciphertexts` is empty.
         */
-        void rotate_columns(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+        void multiply_many(const std::vector<seal::Ciphertext>& ciphertexts, seal::Ciphertext& destination) const;
 
         /**
-        Rotates the columns of the ciphertext and returns the result.
+        Multiplies many ciphertexts in a balanced tree and returns the result.
 
-        @param[in] ciphertext The input ciphertext to rotate.
-        @return A new ciphertext containing the rotated result.
+        @param[in] ciphertexts The ciphertexts to multiply. Must not be empty.
+        @return A new ciphertext containing the product.
+
+        @throws std::invalid_argument If `ciphertexts` is empty.
+        */
+        seal::Ciphertext multiply_many(const std::vector<seal::Ciphertext>& ciphertexts) const;
+
+        // Arithmetic operations: Squaring
+        void square(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+        seal::Ciphertext square(const seal::Ciphertext& ciphertext) const;
+        void square_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Raises a ciphertext to a positive integer power with minimal multiplicative depth.
 
         @details
-        This overload simplifies column rotation by internally managing the destination ciphertext.
+        The powers `x^(2^i)` are computed by repeated squaring. The ones selected by the binary expansion of
+        `exponent` are then multiplied in a balanced tree that always combines the two shallowest terms first,
+        so the result has depth `ceil(log2(exponent))`. Every product is relinearized once.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @param[in] ciphertext The ciphertext to exponentiate.
+        @param[in] exponent The exponent. Must be at least 1.
+        @param[out] destination The ciphertext containing `ciphertext^exponent`.
+
+        @throws std::invalid_argument If `exponent` is 0.
         */
-        seal::Ciphertext rotate_columns(const seal::Ciphertext& ciphertext) const;
+        void power(const seal::Ciphertext& ciphertext, const uint64_t exponent, seal::Ciphertext& destination) const;
 
         /**
-        Performs a row-wise summation on the ciphertext over a specified range size.
+        Raises a ciphertext to a positive integer power with minimal multiplicative depth and returns the result.
+
+        @param[in] ciphertext The ciphertext to exponentiate.
+        @param[in] exponent The exponent. Must be at least 1.
+        @return A new ciphertext containing `ciphertext^exponent`.
+
+        @throws std::invalid_argument If `exponent` is 0.
+        */
+        seal::Ciphertext power(const seal::Ciphertext& ciphertext, const uint64_t exponent) const;
+
+        /**
+        Computes the inner product of two ciphertext vectors with a single relinearization.
 
         @details
-        This function performs a summation across rows within the ciphertext over the specified range size.
-        Row rotation and addition operations are iteratively performed until the sum over the range is computed.
-        The operation assumes that the ciphertext is encoded in a batched format.
+        Each pair `lhs[i] * rhs[i]` is multiplied without relinearization and the size-3 products are
+        accumulated directly. Relinearization and modulus switching (or rescaling for CKKS) are performed
+        once on the accumulated result, so a length-k inner product costs one key switch instead of k.
+        All `2k` inputs are first aligned once to the lowest level among them (and a common scale for CKKS),
+        so that every product has the same level and scale.
 
-        @param[in] ciphertext The input ciphertext on which the row summation will be performed.
-        @param[in] range_size The range size over which rows will be summed. Must be a power of 2.
-        @param[out] destination The ciphertext containing the row-summed result.
+        @param[in] lhs The left-hand operands.
+        @param[in] rhs The right-hand operands.
+        @param[out] destination The ciphertext containing the sum of products.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
-        @throws std::invalid_argument If `range_size` is not a power of 2 or is outside the valid range.
+        @throws std::invalid_argument If `lhs` and `rhs` are empty or differ in length.
         */
-        void row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const;
+        void sum_of_products(const std::vector<seal::Ciphertext>& lhs, const std::vector<seal::Ciphertext>& rhs, seal::Ciphertext& destination) const;
 
         /**
-        Performs a row-wise summation on the ciphertext over a specified range size and returns the result.
+        Computes the inner product of two ciphertext vectors with a single relinearization and returns the result.
+
+        @param[in] lhs The left-hand operands.
+        @param[in] rhs The right-hand operands.
+        @return A new ciphertext containing the sum of products.
+
+        @throws std::invalid_argument If `lhs` and `rhs` are empty or differ in length.
+        */
+        seal::Ciphertext sum_of_products(const std::vector<seal::Ciphertext>& lhs, const std::vector<seal::Ciphertext>& rhs) const;
+
+        /**
+        Accumulates the product of two ciphertexts into an accumulator (`accumulator += ciphertext1 * ciphertext2`).
 
         @details
-        This overload simplifies row summation by internally managing the destination ciphertext.
+        The levels of the two operands are compared and aligned once, and the product is added to the accumulator
+        without relinearization, modulus switching, or rescaling. Call `finalize_accumulator` once the accumulation
+        ends. An empty (default-constructed) accumulator is initialized with the first product.
 
-        @param[in] ciphertext The input ciphertext on which the row summation will be performed.
-        @param[in] range_size The range size over which rows will be summed. Must be a power of 2.
-        @return A new ciphertext containing the row-summed result.
+        @param[in,out] accumulator The accumulator to add the product to.
+        @param[in] ciphertext1 The first factor.
+        @param[in] ciphertext2 The second factor.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
-        @throws std::invalid_argument If `range_size` is not a power of 2 or is outside the valid range.
+        @throws std::invalid_argument If the scheme is CKKS and the product does not match the level and scale of the accumulator.
         */
-        seal::Ciphertext row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const;
+        void multiply_add(seal::Ciphertext& accumulator, const seal::Ciphertext& ciphertext1, const seal::Ciphertext& ciphertext2) const;
 
         /**
-        Performs a column-wise summation on the ciphertext.
+        Accumulates the product of a ciphertext and a plaintext into an accumulator (`accumulator += ciphertext * plaintext`).
 
         @details
-        This function adds the left and right halves of the ciphertext matrix representation, effectively summing the columns.
-        It relies on column rotation followed by addition.
+        The plaintext is matched to the ciphertext once (CKKS only), and the product is added to the accumulator
+        without modulus switching or rescaling. Call `finalize_accumulator` once the accumulation ends.
+        An empty (default-constructed) accumulator is initialized with the first product.
 
-        @param[in] ciphertext The input ciphertext on which the column summation will be performed.
-        @param[out] destination The ciphertext containing the column-summed result.
+        @param[in,out] accumulator The accumulator to add the product to.
+        @param[in] ciphertext The ciphertext factor.
+        @param[in] plaintext The plaintext factor.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @throws std::invalid_argument If the scheme is CKKS and the product does not match the level and scale of the accumulator.
         */
-        void column_sum(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+        void multiply_plain_add(seal::Ciphertext& accumulator, const seal::Ciphertext& ciphertext, const seal::Plaintext& plaintext) const;
 
         /**
-        Performs a column-wise summation on the ciphertext and returns the result.
+        Finishes an accumulation started with `multiply_add` or `multiply_plain_add`.
 
         @details
-        This overload simplifies column summation by internally managing the destination ciphertext.
-
-        @param[in] ciphertext The input ciphertext on which the column summation will be performed.
-        @return A new ciphertext containing the column-summed result.
+        Relinearizes the accumulator once and applies the modulus switching policy (BGV/BFV) or rescaling (CKKS),
+        exactly as `multiply` does for a single product.
 
-        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @param[in,out] accumulator The accumulator to finish.
         */
-        seal::Ciphertext column_sum(const seal::Ciphertext& ciphertext) const;
+        void finalize_accumulator(seal::Ciphertext& accumulator) const;
 
-    private:
+        // Negation
+        void negate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+        seal::Ciphertext negate(const seal::Ciphertext& ciphertext) const;
+        void negate_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Adds a scalar constant to every slot of a ciphertext in place.
+
+        @details
+        The constant is encoded directly as a constant polynomial at the parameters and scale of the ciphertext.
+        This skips the batching NTT (BGV/BFV) or the FFT (CKKS) of a full-vector encoding. A complex constant with
+        a nonzero imaginary part is not a constant polynomial in CKKS and is encoded as a full vector.
+        For BGV/BFV, `double_t` constants are truncated and complex constants use their real part, as in `encode`.
+        In convolution mode, the constant is added to the constant coefficient only.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in,out] ciphertext The ciphertext to modify.
+        @param[in] scalar The constant.
+        */
         template <
             typename T, typename = std::enable_if_t<
             std::is_same<std::remove_cv_t<T>, int64_t>::value ||
             std::is_same<std::remove_cv_t<T>, double_t>::value ||
             std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
-        >void encode_internal(const std::vector<T>& vector, seal::Plaintext& destination, const mul_mode_t mul_mode, const double_t scale, const seal::parms_id_type *param_id = nullptr) const
+        >void add_scalar_inplace(seal::Ciphertext& ciphertext, const T scalar) const
         {
-            if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
-            {
-                // Encoding for BGV/BFV schemes
-                if constexpr (std::is_same<T, int64_t>::value)
-                {
-                    batch_encoder_->encode(vector, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                }
-                else if constexpr (std::is_same<T, double_t>::value)
-                {
-                    batch_encoder_->encode(std::vector<int64_t>(vector.begin(), vector.end()), destination, static_cast<seal::mul_mode_type>(mul_mode));
-                }
-                else if constexpr (std::is_same<T, std::complex<double_t>>::value)
-                {
-                    std::vector<int64_t> conv_vector(vector.size());
-                    std::transform(vector.begin(), vector.end(), conv_vector.begin(), [](const std::complex<double_t>& e) { return static_cast<int64_t>(e.real()); });
-                    batch_encoder_->encode(conv_vector, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                }
-            }
-            else if (scheme_ == seal::scheme_type::ckks)
-            {
-                // Encoding for CKKS schemes
-                if constexpr (std::is_same<T, int64_t>::value)
-                {
-                    if (param_id == nullptr)
-                    {
-                        ckks_encoder_->encode(std::vector<double_t>(vector.begin(), vector.end()), scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                    }
-                    else
-                    {
-                        ckks_encoder_->encode(std::vector<double_t>(vector.begin(), vector.end()), *param_id, scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                    }
-                }
-                else
-                {
-                    if (param_id == nullptr)
-                    {
-                        ckks_encoder_->encode(vector, scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                    }
-                    else
-                    {
-                        ckks_encoder_->encode(vector, *param_id, scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                    }
-                }
-            }
+            seal::Plaintext plain(memory_pool());
+            encode_scalar(scalar, ciphertext, plain);
+            add_inplace(ciphertext, plain);
         }
 
+        /**
+        Adds a scalar constant to every slot of a ciphertext.
+
+        @details
+        See `add_scalar_inplace` for how the constant is encoded.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @param[out] destination The ciphertext to store the result.
+        */
         template <
             typename T, typename = std::enable_if_t<
             std::is_same<std::remove_cv_t<T>, int64_t>::value ||
             std::is_same<std::remove_cv_t<T>, double_t>::value ||
             std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
-        >void decode_internal(const seal::Plaintext& plaintext, std::vector<T>& destination, const mul_mode_t mul_mode) const
+        >void add_scalar(const seal::Ciphertext& ciphertext, const T scalar, seal::Ciphertext& destination) const
         {
-            if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
-            {
-                // Decoding for BGV/BFV schemes
-                if constexpr (std::is_same<T, int64_t>::value)
-                {
-                    batch_encoder_->decode(plaintext, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                }
-                else
-                {
-                    std::vector<int64_t> temp_vector;
-                    batch_encoder_->decode(plaintext, temp_vector, static_cast<seal::mul_mode_type>(mul_mode));
-                    destination.assign(temp_vector.begin(), temp_vector.end());
-                }
-            }
-            else if (scheme_ == seal::scheme_type::ckks)
+            if (&ciphertext != &destination)
             {
-                // Decoding for CKKS schemes
-                if constexpr (std::is_same<T, int64_t>::value)
-                {
-                    std::vector<double_t> temp_vector;
-                    ckks_encoder_->decode(plaintext, temp_vector, static_cast<seal::mul_mode_type>(mul_mode));
-                    destination.assign(temp_vector.begin(), temp_vector.end());
-                }
-                else
-                {
-                    ckks_encoder_->decode(plaintext, destination, static_cast<seal::mul_mode_type>(mul_mode));
-                }
+                destination = ciphertext;
             }
-        }
-
-        seal::scheme_type scheme_;
 
-        seal::sec_level_type sec_level_;
+            add_scalar_inplace(destination, scalar);
+        }
 
-        std::unique_ptr<seal::SEALContext> context_;
+        /**
+        Adds a scalar constant to every slot of a ciphertext and returns the result.
 
-        std::unique_ptr<seal::BatchEncoder> batch_encoder_;
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @return A new ciphertext containing the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >seal::Ciphertext add_scalar(const seal::Ciphertext& ciphertext, const T scalar) const
+        {
+            seal::Ciphertext destination;
+            add_scalar(ciphertext, scalar, destination);
+            return destination;
+        }
+
+        /**
+        Subtracts a scalar constant from every slot of a ciphertext in place.
+
+        @details
+        See `add_scalar_inplace` for how the constant is encoded.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in,out] ciphertext The ciphertext to modify.
+        @param[in] scalar The constant.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void sub_scalar_inplace(seal::Ciphertext& ciphertext, const T scalar) const
+        {
+            seal::Plaintext plain(memory_pool());
+            encode_scalar(scalar, ciphertext, plain);
+            sub_inplace(ciphertext, plain);
+        }
+
+        /**
+        Subtracts a scalar constant from every slot of a ciphertext.
+
+        @details
+        See `add_scalar_inplace` for how the constant is encoded.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @param[out] destination The ciphertext to store the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void sub_scalar(const seal::Ciphertext& ciphertext, const T scalar, seal::Ciphertext& destination) const
+        {
+            if (&ciphertext != &destination)
+            {
+                destination = ciphertext;
+            }
+
+            sub_scalar_inplace(destination, scalar);
+        }
+
+        /**
+        Subtracts a scalar constant from every slot of a ciphertext and returns the result.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @return A new ciphertext containing the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >seal::Ciphertext sub_scalar(const seal::Ciphertext& ciphertext, const T scalar) const
+        {
+            seal::Ciphertext destination;
+            sub_scalar(ciphertext, scalar, destination);
+            return destination;
+        }
+
+        /**
+        Multiplies every slot of a ciphertext by a scalar constant in place.
+
+        @details
+        See `add_scalar_inplace` for how the constant is encoded. For CKKS, an `int64_t` constant is encoded
+        with scale 1, so the product needs no rescaling and consumes no level. Other constants are multiplied
+        like a plaintext, followed by modulus switching or rescaling as in `multiply`.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in,out] ciphertext The ciphertext to modify.
+        @param[in] scalar The constant.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void multiply_scalar_inplace(seal::Ciphertext& ciphertext, const T scalar) const
+        {
+            if constexpr (std::is_same<T, int64_t>::value)
+            {
+                if (scheme_ == seal::scheme_type::ckks)
+                {
+                    multiply_integer_inplace(ciphertext, scalar);
+                    return;
+                }
+            }
+
+            seal::Plaintext plain(memory_pool());
+            encode_scalar(scalar, ciphertext, plain);
+            multiply_inplace(ciphertext, plain);
+        }
+
+        /**
+        Multiplies every slot of a ciphertext by a scalar constant.
+
+        @details
+        See `add_scalar_inplace` for how the constant is encoded.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @param[out] destination The ciphertext to store the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void multiply_scalar(const seal::Ciphertext& ciphertext, const T scalar, seal::Ciphertext& destination) const
+        {
+            if (&ciphertext != &destination)
+            {
+                destination = ciphertext;
+            }
+
+            multiply_scalar_inplace(destination, scalar);
+        }
+
+        /**
+        Multiplies every slot of a ciphertext by a scalar constant and returns the result.
+
+        @tparam T Supported types for the constant (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] ciphertext The ciphertext operand.
+        @param[in] scalar The constant.
+        @return A new ciphertext containing the result.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >seal::Ciphertext multiply_scalar(const seal::Ciphertext& ciphertext, const T scalar) const
+        {
+            seal::Ciphertext destination;
+            multiply_scalar(ciphertext, scalar, destination);
+            return destination;
+        }
+
+        /**
+        Rotates the rows of the ciphertext by a specified step.
+
+        @details
+        Row rotation is a slot-wise operation where elements within the ciphertext matrix are shifted
+        by the specified `step`. This function requires Galois keys to be pre-generated and accessible
+        via `galois_keys_`.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The number of slots to rotate the rows. Positive for right, negative for left.
+        @param[out] destination The ciphertext containing the rotated result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void rotate_rows(const seal::Ciphertext& ciphertext, const int step, seal::Ciphertext& destination) const;
+
+        /**
+        Rotates the rows of the ciphertext by a specified step and returns the result.
+
+        @details
+        This overload provides a simplified interface for row rotation by internally managing the destination ciphertext.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The number of slots to rotate the rows. Positive for right, negative for left.
+        @return A new ciphertext containing the rotated result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        seal::Ciphertext rotate_rows(const seal::Ciphertext& ciphertext, const int step) const;
+
+        /**
+        Rotates the rows of the ciphertext in place by a specified step.
+
+        @param[in,out] ciphertext The ciphertext to rotate.
+        @param[in] step The number of slots to rotate the rows. Positive for right, negative for left.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void rotate_rows_inplace(seal::Ciphertext& ciphertext, const int step) const;
+
+        /**
+        Rotates the columns of the ciphertext.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[out] destination The ciphertext containing the rotated result.
+
+        @details
+        Column rotation is a global permutation of slots in the ciphertext, essentially swapping the left and right halves of the matrix representation.
+        This operation requires Galois keys to be pre-generated and accessible via `galois_keys_`.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void rotate_columns(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+
+        /**
+        Rotates the columns of the ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @return A new ciphertext containing the rotated result.
+
+        @details
+        This overload simplifies column rotation by internally managing the destination ciphertext.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        seal::Ciphertext rotate_columns(const seal::Ciphertext& ciphertext) const;
+
+        /**
+        Rotates the columns of the ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to rotate.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void rotate_columns_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Performs a row-wise summation on the ciphertext over a specified range size.
+
+        @details
+        This function performs a summation across rows within the ciphertext over the specified range size.
+        After the summation, every slot `i` of a row holds the sum of slots `i` to `i + range_size - 1` (cyclically
+        within the row). The range size is decomposed into signed powers of 2 (binary or non-adjacent form, whichever
+        needs fewer rotations), so a range of any length takes about `log2(range_size)` rotations and no masks.
+        The operation assumes that the ciphertext is encoded in a batched format.
+
+        @param[in] ciphertext The input ciphertext on which the row summation will be performed.
+        @param[in] range_size The range size over which rows will be summed.
+        @param[out] destination The ciphertext containing the row-summed result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const;
+
+        /**
+        Performs a row-wise summation on the ciphertext over a specified range size and returns the result.
+
+        @details
+        This overload simplifies row summation by internally managing the destination ciphertext.
+
+        @param[in] ciphertext The input ciphertext on which the row summation will be performed.
+        @param[in] range_size The range size over which rows will be summed.
+        @return A new ciphertext containing the row-summed result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        seal::Ciphertext row_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Performs a row-wise summation on the ciphertext in place over a specified range size.
+
+        @param[in,out] ciphertext The ciphertext on which the row summation will be performed.
+        @param[in] range_size The range size over which rows will be summed.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void row_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Performs a column-wise summation on the ciphertext.
+
+        @details
+        This function adds the left and right halves of the ciphertext matrix representation, effectively summing the columns.
+        It relies on column rotation followed by addition.
+
+        @param[in] ciphertext The input ciphertext on which the column summation will be performed.
+        @param[out] destination The ciphertext containing the column-summed result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void column_sum(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+
+        /**
+        Performs a column-wise summation on the ciphertext and returns the result.
+
+        @details
+        This overload simplifies column summation by internally managing the destination ciphertext.
+
+        @param[in] ciphertext The input ciphertext on which the column summation will be performed.
+        @return A new ciphertext containing the column-summed result.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        seal::Ciphertext column_sum(const seal::Ciphertext& ciphertext) const;
+
+        /**
+        Performs a column-wise summation on the ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext on which the column summation will be performed.
+
+        @throws std::invalid_argument If the scheme is not BGV or BFV.
+        */
+        void column_sum_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Rotates the slot vector of a CKKS ciphertext by a specified step.
+
+        @details
+        CKKS slots form a single vector of `slot_count()` elements, which is rotated cyclically.
+        This function requires Galois keys for the step (or for the power-of-two steps it decomposes into).
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The number of slots to rotate. Positive for left, negative for right.
+        @param[out] destination The ciphertext containing the rotated result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        void rotate_vector(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const;
+
+        /**
+        Rotates the slot vector of a CKKS ciphertext by a specified step and returns the result.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The number of slots to rotate. Positive for left, negative for right.
+        @return A new ciphertext containing the rotated result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        seal::Ciphertext rotate_vector(const seal::Ciphertext& ciphertext, const int32_t step) const;
+
+        /**
+        Rotates the slot vector of a CKKS ciphertext in place by a specified step.
+
+        @param[in,out] ciphertext The ciphertext to rotate.
+        @param[in] step The number of slots to rotate. Positive for left, negative for right.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        void rotate_vector_inplace(seal::Ciphertext& ciphertext, const int32_t step) const;
+
+        /**
+        Complex conjugates every slot of a CKKS ciphertext.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[out] destination The ciphertext containing the conjugated result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        void complex_conjugate(const seal::Ciphertext& ciphertext, seal::Ciphertext& destination) const;
+
+        /**
+        Complex conjugates every slot of a CKKS ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext.
+        @return A new ciphertext containing the conjugated result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        seal::Ciphertext complex_conjugate(const seal::Ciphertext& ciphertext) const;
+
+        /**
+        Complex conjugates every slot of a CKKS ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to conjugate.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        */
+        void complex_conjugate_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Performs a slot-wise summation on a CKKS ciphertext over a specified range size.
+
+        @details
+        After the summation, every slot `i` holds the sum of slots `i` to `i + range_size - 1` (cyclically);
+        in particular, every slot whose index is a multiple of `range_size` holds the sum of its range.
+        The range size need not be a power of 2; it is decomposed as in `row_sum`, taking about `log2(range_size)`
+        rotations, and the additions use the same level and scale handling as `add`.
+
+        @param[in] ciphertext The input ciphertext on which the summation will be performed.
+        @param[in] range_size The range size over which slots will be summed.
+        @param[out] destination The ciphertext containing the summed result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void slot_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const;
+
+        /**
+        Performs a slot-wise summation on a CKKS ciphertext over a specified range size and returns the result.
+
+        @param[in] ciphertext The input ciphertext on which the summation will be performed.
+        @param[in] range_size The range size over which slots will be summed.
+        @return A new ciphertext containing the summed result.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        seal::Ciphertext slot_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Performs a slot-wise summation on a CKKS ciphertext in place over a specified range size.
+
+        @param[in,out] ciphertext The ciphertext on which the summation will be performed.
+        @param[in] range_size The range size over which slots will be summed.
+
+        @throws std::invalid_argument If the scheme is not CKKS.
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void slot_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Computes the inclusive prefix sum (scan) of the leading slots of a ciphertext.
+
+        @details
+        Works on each row for BGV/BFV and on the slot vector for CKKS. After the scan, every slot `i` below
+        `range_size` holds the sum of slots `0` to `i`. The slots from `range_size` on are cleared by a single mask
+        before the scan; when `range_size` is at most half the row, the `log2(range_size)` rotate-and-add steps
+        need no further masks, and the slots from `range_size` on are left with partial sums to be ignored.
+        Longer ranges take one mask per step (and, for CKKS, one level per mask) to stop the rotations from wrapping.
+
+        @param[in] ciphertext The input ciphertext to scan.
+        @param[in] range_size The number of leading slots to scan.
+        @param[out] destination The ciphertext containing the prefix sums.
+
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void prefix_sum(const seal::Ciphertext& ciphertext, const int32_t range_size, seal::Ciphertext& destination) const;
+
+        /**
+        Computes the inclusive prefix sum (scan) of the leading slots of a ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext to scan.
+        @param[in] range_size The number of leading slots to scan.
+        @return A new ciphertext containing the prefix sums.
+
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        seal::Ciphertext prefix_sum(const seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Computes the inclusive prefix sum (scan) of the leading slots of a ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to scan.
+        @param[in] range_size The number of leading slots to scan.
+
+        @throws std::invalid_argument If `range_size` is outside the valid range.
+        */
+        void prefix_sum_inplace(seal::Ciphertext& ciphertext, const int32_t range_size) const;
+
+        /**
+        Computes a trailing sliding-window sum over the slots of a ciphertext.
+
+        @details
+        Works on each row for BGV/BFV and on the slot vector for CKKS. After the summation, every slot `i` holds
+        the sum of slots `i - window_size + 1` to `i`, cyclically, so leading slots only see a partial window if the
+        tail of the row is zero. Dividing by the window size gives a moving average. The window is decomposed in
+        the same way as in `row_sum`, so it takes about `log2(window_size)` rotations and no masks.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] window_size The number of slots in each window.
+        @param[out] destination The ciphertext containing the window sums.
+
+        @throws std::invalid_argument If `window_size` is outside the valid range.
+        */
+        void window_sum(const seal::Ciphertext& ciphertext, const int32_t window_size, seal::Ciphertext& destination) const;
+
+        /**
+        Computes a trailing sliding-window sum over the slots of a ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] window_size The number of slots in each window.
+        @return A new ciphertext containing the window sums.
+
+        @throws std::invalid_argument If `window_size` is outside the valid range.
+        */
+        seal::Ciphertext window_sum(const seal::Ciphertext& ciphertext, const int32_t window_size) const;
+
+        /**
+        Computes a trailing sliding-window sum over the slots of a ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to sum.
+        @param[in] window_size The number of slots in each window.
+
+        @throws std::invalid_argument If `window_size` is outside the valid range.
+        */
+        void window_sum_inplace(seal::Ciphertext& ciphertext, const int32_t window_size) const;
+
+        /**
+        Broadcasts one slot of a ciphertext to every slot.
+
+        @details
+        The slot is isolated with a single mask multiplication, then spread by `log2(row size)` rotation doublings.
+        For BGV/BFV the index covers both rows, and one column rotation copies the filled row to the other.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] index The index of the slot to broadcast.
+        @param[out] destination The ciphertext whose slots all hold the value of the slot.
+
+        @throws std::invalid_argument If `index` is outside the slot range.
+        */
+        void broadcast_slot(const seal::Ciphertext& ciphertext, const int32_t index, seal::Ciphertext& destination) const;
+
+        /**
+        Broadcasts one slot of a ciphertext to every slot and returns the result.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] index The index of the slot to broadcast.
+        @return A new ciphertext whose slots all hold the value of the slot.
+
+        @throws std::invalid_argument If `index` is outside the slot range.
+        */
+        seal::Ciphertext broadcast_slot(const seal::Ciphertext& ciphertext, const int32_t index) const;
+
+        /**
+        Broadcasts one slot of a ciphertext to every slot in place.
+
+        @param[in,out] ciphertext The ciphertext to broadcast.
+        @param[in] index The index of the slot to broadcast.
+
+        @throws std::invalid_argument If `index` is outside the slot range.
+        */
+        void broadcast_slot_inplace(seal::Ciphertext& ciphertext, const int32_t index) const;
+
+        /**
+        Extracts a range of slots and tiles it across the ciphertext.
+
+        @details
+        Works on each row for BGV/BFV and on the slot vector for CKKS. The slots `begin` to `begin + size - 1` are
+        kept by a single mask multiplication, moved to the front, and copied to every multiple of `size`; the
+        copies are placed with about `log2(row size / size)` rotations. If `size` does not divide the row, the
+        slots past the last full copy are zero.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] begin The first slot of the range.
+        @param[in] size The number of slots in the range.
+        @param[out] destination The ciphertext holding the tiled range.
+
+        @throws std::invalid_argument If the range is empty or not within a row.
+        */
+        void extract(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size, seal::Ciphertext& destination) const;
+
+        /**
+        Extracts a range of slots, tiles it across the ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] begin The first slot of the range.
+        @param[in] size The number of slots in the range.
+        @return A new ciphertext holding the tiled range.
+
+        @throws std::invalid_argument If the range is empty or not within a row.
+        */
+        seal::Ciphertext extract(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const;
+
+        /**
+        Extracts a range of slots and tiles it across the ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to extract from.
+        @param[in] begin The first slot of the range.
+        @param[in] size The number of slots in the range.
+
+        @throws std::invalid_argument If the range is empty or not within a row.
+        */
+        void extract_inplace(seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const;
+
+        /**
+        Replicates the leading block of slots across the ciphertext.
+
+        @details
+        Equivalent to `extract(ciphertext, 0, block_size)`: one mask multiplication, then rotation doublings.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] block_size The number of leading slots to replicate.
+        @param[out] destination The ciphertext holding the replicated block.
+
+        @throws std::invalid_argument If `block_size` is outside the valid range.
+        */
+        void replicate(const seal::Ciphertext& ciphertext, const int32_t block_size, seal::Ciphertext& destination) const;
+
+        /**
+        Replicates the leading block of slots across the ciphertext and returns the result.
+
+        @param[in] ciphertext The input ciphertext.
+        @param[in] block_size The number of leading slots to replicate.
+        @return A new ciphertext holding the replicated block.
+
+        @throws std::invalid_argument If `block_size` is outside the valid range.
+        */
+        seal::Ciphertext replicate(const seal::Ciphertext& ciphertext, const int32_t block_size) const;
+
+        /**
+        Replicates the leading block of slots across the ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to replicate.
+        @param[in] block_size The number of leading slots to replicate.
+
+        @throws std::invalid_argument If `block_size` is outside the valid range.
+        */
+        void replicate_inplace(seal::Ciphertext& ciphertext, const int32_t block_size) const;
+
+        /**
+        Rotates the rows (BGV/BFV) or the slot vector (CKKS) of a ciphertext by a specified step.
+
+        @details
+        A scheme-independent form of `rotate_rows` and `rotate_vector`. Positive steps rotate left.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The rotation step.
+        @param[out] destination The rotated ciphertext.
+        */
+        void rotate(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const;
+
+        /**
+        Rotates the rows (BGV/BFV) or the slot vector (CKKS) of a ciphertext by a specified step and returns the result.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] step The rotation step.
+        @return A new rotated ciphertext.
+        */
+        seal::Ciphertext rotate(const seal::Ciphertext& ciphertext, const int32_t step) const;
+
+        /**
+        Rotates the rows (BGV/BFV) or the slot vector (CKKS) of a ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to rotate.
+        @param[in] step The rotation step.
+        */
+        void rotate_inplace(seal::Ciphertext& ciphertext, const int32_t step) const;
+
+        /**
+        Zeroes every slot outside a range of each row (of the slot vector for CKKS) in place.
+
+        @details
+        Costs one plaintext mask multiplication.
+
+        @param[in,out] ciphertext The ciphertext to mask.
+        @param[in] begin The first slot of the range.
+        @param[in] size The number of slots in the range.
+
+        @throws std::invalid_argument If the range is empty or not within a row.
+        */
+        void mask_range_inplace(seal::Ciphertext& ciphertext, const int32_t begin, const int32_t size) const;
+
+        /**
+        Rotates one ciphertext by many steps.
+
+        @details
+        Rotates rows for BGV/BFV and the slot vector for CKKS. SEAL does not expose its key switching
+        decomposition, so it cannot be shared across steps; instead, the work is shared at the key level.
+        Steps with a Galois key of their own are rotated from the input first, in parallel. Every other step is
+        derived from one of those results with a single key switch when a key for the difference exists, instead
+        of being decomposed into several power-of-two rotations of the input. The remaining steps are rotated
+        from the input as usual.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] steps The rotation steps.
+        @param[out] destination The rotated ciphertexts, in the order of `steps`.
+        */
+        void rotate_many(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& steps, std::vector<seal::Ciphertext>& destination) const;
+
+        /**
+        Rotates one ciphertext by many steps and returns the results.
+
+        @param[in] ciphertext The input ciphertext to rotate.
+        @param[in] steps The rotation steps.
+        @return The rotated ciphertexts, in the order of `steps`.
+        */
+        std::vector<seal::Ciphertext> rotate_many(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& steps) const;
+
+        /**
+        Packs the useful slots of sparse ciphertexts into as few dense ciphertexts as possible.
+
+        @details
+        Each input is expected to hold useful values only at multiples of `stride`, as left by `row_sum` or
+        `slot_sum` with a range size of `stride`. Every input is masked down to those slots and rotated by its
+        position in the group, and `stride` inputs are added into one packed ciphertext, which reduces the
+        ciphertext count by the sparsity factor. Groups are packed in parallel. This costs one mask multiplication
+        and one rotation per input; see `pack_layout_t` for the resulting layout.
+
+        @param[in] ciphertexts The sparse ciphertexts.
+        @param[in] stride The distance between useful slots. Must divide the row size (the slot count for CKKS).
+        @param[out] destination The packed ciphertexts.
+        @param[out] layout The layout needed to unpack the result.
+
+        @throws std::invalid_argument If `ciphertexts` is empty or `stride` does not divide the row size.
+        */
+        void pack(const std::vector<seal::Ciphertext>& ciphertexts, const int32_t stride, std::vector<seal::Ciphertext>& destination, pack_layout_t& layout) const;
+
+        /**
+        Packs the useful slots of sparse ciphertexts into as few dense ciphertexts as possible and returns them.
+
+        @param[in] ciphertexts The sparse ciphertexts.
+        @param[in] stride The distance between useful slots. Must divide the row size (the slot count for CKKS).
+        @param[out] layout The layout needed to unpack the result.
+        @return The packed ciphertexts.
+
+        @throws std::invalid_argument If `ciphertexts` is empty or `stride` does not divide the row size.
+        */
+        std::vector<seal::Ciphertext> pack(const std::vector<seal::Ciphertext>& ciphertexts, const int32_t stride, pack_layout_t& layout) const;
+
+        /**
+        Restores sparse ciphertexts from packed ones.
+
+        @details
+        Input `k` is recovered with one mask multiplication and one rotation, with its values back at multiples of
+        the stride and zero elsewhere.
+
+        @param[in] packed The packed ciphertexts.
+        @param[in] layout The layout returned by `pack`.
+        @param[out] destination The restored ciphertexts.
+
+        @throws std::invalid_argument If `packed` does not match `layout`.
+        */
+        void unpack(const std::vector<seal::Ciphertext>& packed, const pack_layout_t& layout, std::vector<seal::Ciphertext>& destination) const;
+
+        /**
+        Restores sparse ciphertexts from packed ones and returns them.
+
+        @param[in] packed The packed ciphertexts.
+        @param[in] layout The layout returned by `pack`.
+        @return The restored ciphertexts.
+
+        @throws std::invalid_argument If `packed` does not match `layout`.
+        */
+        std::vector<seal::Ciphertext> unpack(const std::vector<seal::Ciphertext>& packed, const pack_layout_t& layout) const;
+
+        /**
+        Encodes two real vectors into the real and imaginary parts of one CKKS plaintext.
+
+        @details
+        Slot `i` holds `first[i] + i * second[i]`, so one ciphertext carries both vectors. Additions, rotations,
+        and multiplications by real constants or real plaintexts act on both vectors at once; multiplying two
+        packed ciphertexts mixes them. Use `separate_pair` on the ciphertext or `decode_pair` on the decrypted
+        plaintext to split the vectors again. The shorter vector is padded with zeros.
+
+        @param[in] first The vector stored in the real parts.
+        @param[in] second The vector stored in the imaginary parts.
+        @param[out] destination The plaintext to store the encoded pair.
+
+        @throws std::invalid_argument If the scheme is not CKKS or the multiplication mode is not element-wise.
+        */
+        void encode_pair(const std::vector<double_t>& first, const std::vector<double_t>& second, seal::Plaintext& destination) const;
+
+        /**
+        Encodes two real vectors into the real and imaginary parts of one CKKS plaintext and returns it.
+
+        @param[in] first The vector stored in the real parts.
+        @param[in] second The vector stored in the imaginary parts.
+        @return The plaintext holding the encoded pair.
+
+        @throws std::invalid_argument If the scheme is not CKKS or the multiplication mode is not element-wise.
+        */
+        seal::Plaintext encode_pair(const std::vector<double_t>& first, const std::vector<double_t>& second) const;
+
+        /**
+        Decodes a CKKS plaintext into the two real vectors stored in its real and imaginary parts.
+
+        @param[in] plaintext The plaintext holding the pair.
+        @param[out] first The vector stored in the real parts.
+        @param[out] second The vector stored in the imaginary parts.
+
+        @throws std::invalid_argument If the scheme is not CKKS or the multiplication mode is not element-wise.
+        */
+        void decode_pair(const seal::Plaintext& plaintext, std::vector<double_t>& first, std::vector<double_t>& second) const;
+
+        /**
+        Separates a CKKS ciphertext holding a pair into one ciphertext per vector.
+
+        @details
+        With `z = a + i * b`, the real parts are `(z + conj(z)) / 2` and the imaginary parts are
+        `(z - conj(z)) / 2i`. This takes one conjugation and no level: the division by `i` is a multiplication
+        by the monomial `-X^(N/2)`, which needs no rescale, and the halving doubles the scale instead. Both
+        outputs stay at the level of the input, with real values in every slot and twice its scale, so the
+        first operation that mixes them with ciphertexts at the regular scale matches the scales at one level.
+
+        @param[in] ciphertext The ciphertext holding the pair.
+        @param[out] first The ciphertext to store the vector from the real parts.
+        @param[out] second The ciphertext to store the vector from the imaginary parts.
+
+        @throws std::invalid_argument If the scheme is not CKKS or the multiplication mode is not element-wise.
+        */
+        void separate_pair(const seal::Ciphertext& ciphertext, seal::Ciphertext& first, seal::Ciphertext& second) const;
+
+        /**
+        Pre-encodes a plaintext matrix as generalized diagonals for `matvec`.
+
+        @details
+        The diagonals are encoded in parallel. For BGV/BFV every row of slots receives the same diagonals, so
+        `matvec` applies the matrix to the vector in each row independently.
+
+        @tparam T The type of the matrix entries (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] matrix The matrix, as a vector of equally long rows.
+        @param[out] destination The encoded matrix.
+
+        @throws std::invalid_argument If the matrix is empty or not rectangular.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_matrix(const std::vector<std::vector<T>>& matrix, diagonal_matrix_t& destination) const
+        {
+            encode_matrix_internal(matrix, destination, nullptr);
+        }
+
+        /**
+        Pre-encodes a plaintext matrix as generalized diagonals for `matvec`, at a specific level.
+
+        @details
+        For CKKS, encoding at the level of the input vector saves switching every diagonal down in `matvec`.
+
+        @tparam T The type of the matrix entries (`int64_t`, `double_t`, or `std::complex<double_t>`).
+        @param[in] matrix The matrix, as a vector of equally long rows.
+        @param[out] destination The encoded matrix.
+        @param[in] param_id The parameter ID identifying the level of the input vector.
+
+        @throws std::invalid_argument If the matrix is empty or not rectangular.
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_matrix(const std::vector<std::vector<T>>& matrix, diagonal_matrix_t& destination, const seal::parms_id_type param_id) const
+        {
+            encode_matrix_internal(matrix, destination, &param_id);
+        }
+
+        /**
+        Multiplies a pre-encoded plaintext matrix by an encrypted vector.
+
+        @details
+        Block column `c` of the vector is ciphertext `c`, with its elements in the first `dimension` slots of each
+        row and zero elsewhere. Each input is replicated across the row with `log2(row size / dimension)`
+        rotations, and its baby-step rotations are shared by every block row. The output block row `r` is
+        ciphertext `r`, laid out like the input. A d x d block takes about `2 * sqrt(d)` rotations, and the
+        products of each giant step are rescaled or modulus switched once.
+
+        @param[in] matrix The encoded matrix.
+        @param[in] vector The encrypted vector, one ciphertext per block column.
+        @param[out] destination The encrypted product, one ciphertext per block row.
+
+        @throws std::invalid_argument If the number of ciphertexts does not match the matrix.
+        */
+        void matvec(const diagonal_matrix_t& matrix, const std::vector<seal::Ciphertext>& vector, std::vector<seal::Ciphertext>& destination) const;
+
+        /**
+        Multiplies a pre-encoded plaintext matrix by an encrypted vector and returns the product.
+
+        @param[in] matrix The encoded matrix.
+        @param[in] vector The encrypted vector, one ciphertext per block column.
+        @return The encrypted product, one ciphertext per block row.
+
+        @throws std::invalid_argument If the number of ciphertexts does not match the matrix.
+        */
+        std::vector<seal::Ciphertext> matvec(const diagonal_matrix_t& matrix, const std::vector<seal::Ciphertext>& vector) const;
+
+        /**
+        Multiplies a pre-encoded plaintext matrix that fits in one block by an encrypted vector.
+
+        @param[in] matrix The encoded matrix.
+        @param[in] vector The encrypted vector.
+        @param[out] destination The encrypted product.
+
+        @throws std::invalid_argument If the matrix does not fit in one block.
+        */
+        void matvec(const diagonal_matrix_t& matrix, const seal::Ciphertext& vector, seal::Ciphertext& destination) const;
+
+        /**
+        Multiplies a pre-encoded plaintext matrix that fits in one block by an encrypted vector and returns the product.
+
+        @param[in] matrix The encoded matrix.
+        @param[in] vector The encrypted vector.
+        @return The encrypted product.
+
+        @throws std::invalid_argument If the matrix does not fit in one block.
+        */
+        seal::Ciphertext matvec(const diagonal_matrix_t& matrix, const seal::Ciphertext& vector) const;
+
+        /**
+        Permutes the slots of each row (of the slot vector for CKKS) of a ciphertext.
+
+        @details
+        Slot `i` of the result receives slot `source[i]` of the same row, or zero if `source[i]` is negative
+        or `i` is past the end of `source`; the source slots may repeat. The slots are grouped by their offset
+        `source[i] - i`, and the offsets are split into baby and giant steps (see `plan_permutation`), so a
+        permutation with `m` offsets in an arithmetic progression takes about `2 * sqrt(m)` rotations and one
+        plaintext multiplication per offset. The result is one level below the input.
+
+        @param[in] ciphertext The ciphertext to permute.
+        @param[in] source The source slot of each slot of the result.
+        @param[out] destination The ciphertext to store the result.
+
+        @throws std::invalid_argument If `source` is longer than a row or refers to a slot outside it.
+        */
+        void permute(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& source, seal::Ciphertext& destination) const;
+
+        /**
+        Permutes the slots of each row (of the slot vector for CKKS) of a ciphertext and returns the result.
+
+        @param[in] ciphertext The ciphertext to permute.
+        @param[in] source The source slot of each slot of the result.
+        @return The permuted ciphertext.
+
+        @throws std::invalid_argument If `source` is longer than a row or refers to a slot outside it.
+        */
+        seal::Ciphertext permute(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& source) const;
+
+        /**
+        Permutes the slots of each row (of the slot vector for CKKS) of a ciphertext in place.
+
+        @param[in,out] ciphertext The ciphertext to permute.
+        @param[in] source The source slot of each slot of the result.
+
+        @throws std::invalid_argument If `source` is longer than a row or refers to a slot outside it.
+        */
+        void permute_inplace(seal::Ciphertext& ciphertext, const std::vector<int32_t>& source) const;
+
+        /**
+        Applies many slot permutations to one ciphertext.
+
+        @details
+        Baby steps only depend on the stride of a permutation's offsets, so they are rotated once from the input
+        and shared by every permutation that needs them; the permutations are then evaluated in parallel.
+
+        @param[in] ciphertext The ciphertext to permute.
+        @param[in] sources The source slots of each permutation, as in `permute`.
+        @param[out] destination The permuted ciphertexts, in the order of `sources`.
+
+        @throws std::invalid_argument If a permutation is longer than a row or refers to a slot outside it.
+        */
+        void permute_many(const seal::Ciphertext& ciphertext, const std::vector<std::vector<int32_t>>& sources, std::vector<seal::Ciphertext>& destination) const;
+
+        /**
+        Applies many slot permutations to one ciphertext and returns the results.
+
+        @param[in] ciphertext The ciphertext to permute.
+        @param[in] sources The source slots of each permutation, as in `permute`.
+        @return The permuted ciphertexts, in the order of `sources`.
+
+        @throws std::invalid_argument If a permutation is longer than a row or refers to a slot outside it.
+        */
+        std::vector<seal::Ciphertext> permute_many(const seal::Ciphertext& ciphertext, const std::vector<std::vector<int32_t>>& sources) const;
+
+    private:
+        /**
+        Lowers a ciphertext to the modulus size of the target ciphertext.
+
+        @details
+        For BGV/BFV the ciphertext is switched directly to the target parameters.
+        For CKKS the scale of the target is matched as well; see `mod_scale_switch_to_inplace`.
+        */
+        void level_down_inplace(seal::Ciphertext& ciphertext, const seal::Ciphertext& target) const;
+
+        /**
+        Brings a CKKS ciphertext to the given parameters and scale.
+
+        @details
+        If the scale already agrees, the ciphertext is only modulus switched, which costs no multiplication.
+        Otherwise it is modulus switched to the level right above the target, multiplied by a constant 1 encoded
+        at `scale * prime / ciphertext.scale()` and rescaled once, which lands on the target scale. The constant
+        is only encoded to a relative precision of `1 / (2c)`, so a correction far below the encoding scale
+        (e.g. an unfinished product at scale `s * s` meeting a ciphertext at scale `s` one level lower) is rejected.
+
+        @throws std::invalid_argument If the target is above the ciphertext, or if the scales differ and either
+        no level is dropped or the correction is below `scale() / 16`.
+        @throws std::invalid_argument If the resulting scale differs from `scale` by more than rounding.
+        */
+        void mod_scale_switch_to_inplace(seal::Ciphertext& ciphertext, const seal::parms_id_type& parms_id, const double_t scale) const;
+
+        /**
+        Aligns an operand with the destination of an in-place operation.
+
+        @details
+        If the destination has the larger modulus it is lowered in place. If the operand has the larger
+        modulus it is copied into `buffer` and lowered there. An operand that is already at the right
+        level is never copied.
+
+        @return A reference to either `operand` or `buffer`, whichever holds the aligned operand.
+        */
+        const seal::Ciphertext& level_matching(seal::Ciphertext& destination, const seal::Ciphertext& operand, seal::Ciphertext& buffer) const;
+
+        /**
+        Aligns many ciphertexts to the lowest level among them (and a common scale for CKKS).
+
+        @details
+        Inputs that already match are referenced directly; the others are lowered into `buffers`.
+
+        @param[in] ciphertexts The ciphertexts to align.
+        @param[out] buffers Storage for the lowered copies, taken from the free list; hand them back with `release_all`.
+        @param[out] aligned Pointers to the aligned ciphertexts, in input order.
+        */
+        void level_matching_many(const std::vector<const seal::Ciphertext*>& ciphertexts, std::vector<seal::Ciphertext>& buffers, std::vector<const seal::Ciphertext*>& aligned) const;
+
+        void level_matching_many(const std::vector<seal::Ciphertext>& ciphertexts, std::vector<seal::Ciphertext>& buffers, std::vector<const seal::Ciphertext*>& aligned) const;
+
+        /**
+        Encodes a scalar constant at the parameters and scale of a ciphertext.
+        For BGV/BFV and real CKKS constants the result is a constant polynomial.
+        */
+        void encode_scalar(const int64_t scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const;
+
+        void encode_scalar(const double_t scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const;
+
+        void encode_scalar(const std::complex<double_t> scalar, const seal::Ciphertext& ciphertext, seal::Plaintext& destination) const;
+
+        /**
+        Multiplies a CKKS ciphertext by an integer constant encoded with scale 1, which needs no rescaling.
+        */
+        void multiply_integer_inplace(seal::Ciphertext& ciphertext, const int64_t scalar) const;
+
+        /**
+        Rotates rows (BGV/BFV) or the slot vector (CKKS) by a specified step.
+        */
+        void rotate_internal(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const;
+
+        /**
+        Performs a single rotation that is known to be keyed, or leaves an unkeyed step to SEAL.
+        */
+        void rotate_keyed(const seal::Ciphertext& ciphertext, const int32_t step, seal::Ciphertext& destination) const;
+
+        /**
+        Sums `window_size` slots that are `stride` apart (negative for backward), so slot `i` receives slots `i + j * stride`.
+        */
+        void sliding_sum_inplace(seal::Ciphertext& ciphertext, const int32_t window_size, const int32_t stride) const;
+
+        /**
+        Encodes a mask with 1 in slots [begin, end) of every row (or only of `row` for BGV/BFV) and 0 elsewhere,
+        at the level of the ciphertext.
+        */
+        void encode_mask(const seal::Ciphertext& ciphertext, const int32_t begin, const int32_t end, seal::Plaintext& destination, const int32_t row = -1) const;
+
+        /**
+        Encodes a mask with 1 in the slots at multiples of `stride` of every row and 0 elsewhere, at the level of the ciphertext.
+        */
+        void encode_stride_mask(const seal::Ciphertext& ciphertext, const int32_t stride, seal::Plaintext& destination) const;
+
+        /**
+        Encodes a mask with 1 in the given slots of every row and 0 elsewhere, at the level of the ciphertext.
+        */
+        void encode_slot_mask(const seal::Ciphertext& ciphertext, const std::vector<int32_t>& slots, seal::Plaintext& destination) const;
+
+        /**
+        Reduces a rotation step to the range (-row_size/2, row_size/2], where 0 means no rotation.
+        */
+        int32_t normalize_step(const int32_t step) const;
+
+        /**
+        Checks whether a Galois key exists for exactly this rotation step, i.e. whether it costs a single key switch.
+        */
+        bool has_rotation_key(const int32_t step) const;
+
+        /**
+        Finishes a multiplication: relinearizes the ciphertext if its size exceeds 2, then performs
+        modulus switching according to the policy (BGV/BFV) or rescaling (CKKS) while more than one prime remains.
+        */
+        void post_multiply_inplace(seal::Ciphertext& ciphertext) const;
+
+        /**
+        Retrieves the thread pool, starting it with `thread_count_` threads on first use.
+        */
+        ThreadPool& thread_pool() const;
+
+        /**
+        Applies the modulus switching policy (`mod_switch_policy_`) to a BGV/BFV ciphertext after multiplication.
+
+        @param[in,out] ciphertext The product.
+        @param[in] ciphertext_product Whether both factors were ciphertexts; only such products are measured by `noise_budget`.
+        */
+        void policy_mod_switch_inplace(seal::Ciphertext& ciphertext, const bool ciphertext_product) const;
+
+        /**
+        Adds an unrescaled product to an accumulator, initializing the accumulator if it is empty.
+        For BGV/BFV the operand with the larger modulus is switched down; for CKKS the level and scale must already match.
+        */
+        void accumulate_inplace(seal::Ciphertext& accumulator, seal::Ciphertext& product) const;
+
+        /**
+        Returns every ciphertext of a vector of scratch buffers to the free list.
+        */
+        void release_all(std::vector<seal::Ciphertext>& ciphertexts) const;
+
+        /**
+        Reduces aligned ciphertexts in a balanced tree with `combine`, running each round on all hardware threads.
+        */
+        void tree_reduce(const std::vector<const seal::Ciphertext*>& aligned, seal::Ciphertext& destination, const std::function<void(seal::Ciphertext&, const seal::Ciphertext&)>& combine) const;
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_internal(const std::vector<T>& vector, seal::Plaintext& destination, const mul_mode_t mul_mode, const double_t scale, const seal::parms_id_type *param_id = nullptr) const
+        {
+            // A vector of the encoder's own type goes straight to the encoder; anything else is converted first.
+            if constexpr (std::is_same<T, int64_t>::value)
+            {
+                if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+                {
+                    batch_encoder_->encode(vector, destination, static_cast<seal::mul_mode_type>(mul_mode));
+                    return;
+                }
+            }
+            else
+            {
+                if (scheme_ == seal::scheme_type::ckks)
+                {
+                    ckks_encode(vector, destination, mul_mode, scale, param_id);
+                    return;
+                }
+            }
+
+            encode_internal(vector.data(), vector.size(), destination, mul_mode, scale, param_id);
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_internal(const T* values, const size_t count, seal::Plaintext& destination, const mul_mode_t mul_mode, const double_t scale, const seal::parms_id_type *param_id = nullptr) const
+        {
+            if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+            {
+                // Encoding for BGV/BFV schemes
+                std::vector<int64_t>& buffer = scratch_buffer<int64_t>();
+                convert_values(values, count, buffer);
+                batch_encoder_->encode(buffer, destination, static_cast<seal::mul_mode_type>(mul_mode));
+            }
+            else if (scheme_ == seal::scheme_type::ckks)
+            {
+                // Encoding for CKKS schemes
+                if constexpr (std::is_same<T, int64_t>::value)
+                {
+                    std::vector<double_t>& buffer = scratch_buffer<double_t>();
+                    convert_values(values, count, buffer);
+                    ckks_encode(buffer, destination, mul_mode, scale, param_id);
+                }
+                else
+                {
+                    std::vector<T>& buffer = scratch_buffer<T>();
+                    convert_values(values, count, buffer);
+                    ckks_encode(buffer, destination, mul_mode, scale, param_id);
+                }
+            }
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void ckks_encode(const std::vector<T>& vector, seal::Plaintext& destination, const mul_mode_t mul_mode, const double_t scale, const seal::parms_id_type *param_id) const
+        {
+            if (param_id == nullptr)
+            {
+                ckks_encoder_->encode(vector, scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
+            }
+            else
+            {
+                ckks_encoder_->encode(vector, *param_id, scale, destination, static_cast<seal::mul_mode_type>(mul_mode));
+            }
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decode_internal(const seal::Plaintext& plaintext, std::vector<T>& destination, const mul_mode_t mul_mode) const
+        {
+            // Decoding straight into the destination when it has the encoder's own type.
+            if constexpr (std::is_same<T, int64_t>::value)
+            {
+                if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+                {
+                    batch_encoder_->decode(plaintext, destination, static_cast<seal::mul_mode_type>(mul_mode));
+                    return;
+                }
+            }
+            else
+            {
+                if (scheme_ == seal::scheme_type::ckks)
+                {
+                    ckks_encoder_->decode(plaintext, destination, static_cast<seal::mul_mode_type>(mul_mode));
+                    return;
+                }
+            }
+
+            destination.resize(static_cast<size_t>(slot_count()));
+            decode_internal(plaintext, destination.data(), destination.size(), mul_mode);
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void decode_internal(const seal::Plaintext& plaintext, T* destination, const size_t count, const mul_mode_t mul_mode) const
+        {
+            if (count > static_cast<size_t>(slot_count()))
+            {
+                throw std::invalid_argument("The number of values must not exceed the slot count.");
+            }
+
+            if (scheme_ == seal::scheme_type::bgv || scheme_ == seal::scheme_type::bfv)
+            {
+                // Decoding for BGV/BFV schemes
+                std::vector<int64_t>& buffer = scratch_buffer<int64_t>();
+                batch_encoder_->decode(plaintext, buffer, static_cast<seal::mul_mode_type>(mul_mode));
+                convert_values(buffer.data(), count, destination);
+            }
+            else if (scheme_ == seal::scheme_type::ckks)
+            {
+                // Decoding for CKKS schemes
+                if constexpr (std::is_same<T, std::complex<double_t>>::value)
+                {
+                    std::vector<T>& buffer = scratch_buffer<T>();
+                    ckks_encoder_->decode(plaintext, buffer, static_cast<seal::mul_mode_type>(mul_mode));
+                    convert_values(buffer.data(), count, destination);
+                }
+                else
+                {
+                    std::vector<double_t>& buffer = scratch_buffer<double_t>();
+                    ckks_encoder_->decode(plaintext, buffer, static_cast<seal::mul_mode_type>(mul_mode));
+                    convert_values(buffer.data(), count, destination);
+                }
+            }
+        }
+
+        /**
+        Returns this thread's reusable conversion buffer for the given type.
+        */
+        template <typename T>
+        static std::vector<T>& scratch_buffer()
+        {
+            thread_local std::vector<T> buffer;
+            return buffer;
+        }
+
+        /**
+        Converts one value as the encoders expect: complex values keep their real part when narrowed, and
+        integers and doubles convert with `static_cast`.
+        */
+        template <typename D, typename S>
+        static D convert_value(const S& value)
+        {
+            if constexpr (std::is_same<S, D>::value)
+            {
+                return value;
+            }
+            else if constexpr (std::is_same<S, std::complex<double_t>>::value)
+            {
+                return static_cast<D>(value.real());
+            }
+            else if constexpr (std::is_same<D, std::complex<double_t>>::value)
+            {
+                return D(static_cast<double_t>(value), 0.0);
+            }
+            else
+            {
+                return static_cast<D>(value);
+            }
+        }
+
+        /**
+        Converts `count` values into a buffer. The loop has no dependencies between iterations, so the compiler
+        vectorizes the int64/double conversions where the target supports them.
+        */
+        template <typename D, typename S>
+        static void convert_values(const S* source, const size_t count, D* destination)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                destination[i] = convert_value<D>(source[i]);
+            }
+        }
+
+        template <typename D, typename S>
+        static void convert_values(const S* source, const size_t count, std::vector<D>& destination)
+        {
+            destination.resize(count);
+            convert_values(source, count, destination.data());
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+            std::is_same<std::remove_cv_t<T>, int64_t>::value ||
+            std::is_same<std::remove_cv_t<T>, double_t>::value ||
+            std::is_same<std::remove_cv_t<T>, std::complex<double_t>>::value>
+        >void encode_matrix_internal(const std::vector<std::vector<T>>& matrix, diagonal_matrix_t& destination, const seal::parms_id_type* param_id) const
+        {
+            const size_t rows = matrix.size();
+            const size_t cols = rows == 0 ? 0 : matrix[0].size();
+
+            if (cols == 0 || std::any_of(matrix.begin(), matrix.end(), [cols](const std::vector<T>& row) { return row.size() != cols; }))
+            {
+                throw std::invalid_argument("The matrix must be non-empty and rectangular.");
+            }
+
+            const int32_t size = row_size();
+            const size_t slots = static_cast<size_t>(slot_count());
+            const size_t dimension = static_cast<size_t>(matvec_dimension(rows, cols, size));
+            const size_t baby_steps = static_cast<size_t>(matvec_baby_steps(static_cast<int32_t>(dimension)));
+
+            destination.rows = rows;
+            destination.cols = cols;
+            destination.dimension = static_cast<int32_t>(dimension);
+            destination.baby_steps = static_cast<int32_t>(baby_steps);
+            destination.row_blocks = (rows + dimension - 1) / dimension;
+            destination.column_blocks = (cols + dimension - 1) / dimension;
+            destination.diagonals.assign(destination.row_blocks * destination.column_blocks * dimension, seal::Plaintext());
+
+            parallel_for(destination.diagonals.size(), [&](size_t index)
+            {
+                const size_t j = index % dimension;
+                const size_t block = index / dimension;
+                const size_t row_offset = (block / destination.column_blocks) * dimension;
+                const size_t col_offset = (block % destination.column_blocks) * dimension;
+
+                // The giant step rotates left by `giant`, so the diagonal is stored that far to the right.
+                const size_t giant = (j / baby_steps) * baby_steps;
+
+                std::vector<T> diagonal(slots, T());
+                bool nonzero = false;
+
+                for (size_t i = 0; i < dimension; i++)
+                {
+                    const size_t r = row_offset + i;
+                    const size_t c = col_offset + (i + j) % dimension;
+
+                    if (r < rows && c < cols && matrix[r][c] != T())
+                    {
+                        for (size_t slot = (giant + i) % size; slot < slots; slot += size)
+                        {
+                            diagonal[slot] = matrix[r][c];
+                        }
+                        nonzero = true;
+                    }
+                }
+
+                if (nonzero)
+                {
+                    encode_internal(diagonal, destination.diagonals[index], mul_mode_, param_id ? level_scale(*param_id) : scale_, param_id);
+                }
+            });
+        }
+
+        seal::scheme_type scheme_;
+
+        seal::sec_level_type sec_level_;
+
+        std::unique_ptr<seal::SEALContext> context_;
+
+        std::unique_ptr<seal::BatchEncoder> batch_encoder_;
 
         std::unique_ptr<seal::CKKSEncoder> ckks_encoder_;
 
         double_t scale_;
 
+        std::vector<double_t> level_scales_;
+
         std::unique_ptr<seal::Encryptor> encryptor_;
 
         std::unique_ptr<seal::Decryptor> decryptor_;
@@ -705,6 +2631,10 @@ namespace fhe
 
         mul_mode_t mul_mode_;
 
+        mod_switch_policy_t mod_switch_policy_;
+
+        size_t mod_switch_level_;
+
         seal::SecretKey secret_key_;
 
         seal::PublicKey public_key_;
@@ -712,5 +2642,21 @@ namespace fhe
         seal::RelinKeys relin_keys_;
 
         seal::GaloisKeys galois_keys_;
+
+        std::vector<int32_t> rotation_routes_;
+
+        size_t thread_count_;
+
+        mutable std::mutex thread_pool_mutex_;
+
+        mutable std::unique_ptr<ThreadPool> thread_pool_;
+
+        bool thread_local_memory_pools_;
+
+        mutable std::mutex free_list_mutex_;
+
+        mutable std::map<seal::parms_id_type, std::vector<seal::Ciphertext>> free_ciphertexts_;
+
+        mutable std::vector<seal::Plaintext> free_plaintexts_;
     };
 } // namespace she
\ No newline at end of file
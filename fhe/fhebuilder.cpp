@@ -9,7 +9,13 @@ namespace fhe
         secret_key_(true),
         public_key_(true),
         relin_keys_(true),
-        galois_keys_(true) {
+        galois_keys_(true),
+        use_rotation_workload_(false),
+        max_key_switches_(2),
+        mod_switch_policy_(mod_switch_policy_t::eager),
+        mod_switch_level_(1),
+        thread_count_(0),
+        thread_local_memory_pools_(false) {
     }
 
     FHEBuilder& FHEBuilder::sec_level(const sec_level_t sec_level) 
@@ -67,6 +73,101 @@ namespace fhe
     {
         galois_keys_ = use;
         rotatin_steps_ = rotatin_steps;
+        use_rotation_workload_ = false;
+        return *this;
+    }
+
+    FHEBuilder& FHEBuilder::galois_keys(const rotation_workload_t& workload, const size_t max_key_switches)
+    {
+        if (max_key_switches < 1)
+        {
+            throw std::invalid_argument("The number of key switches per rotation must be at least 1.");
+        }
+
+        galois_keys_ = true;
+        rotatin_steps_.clear();
+        use_rotation_workload_ = true;
+        rotation_workload_ = workload;
+        max_key_switches_ = max_key_switches;
+        return *this;
+    }
+
+    std::vector<int32_t> FHEBuilder::galois_key_steps(const size_t poly_modulus_degree) const
+    {
+        if (!use_rotation_workload_)
+        {
+            return rotatin_steps_;
+        }
+
+        // Both BGV/BFV rows and the CKKS slot vector hold half of the polynomial modulus degree.
+        const int32_t row_size = static_cast<int32_t>(poly_modulus_degree / 2);
+        std::vector<int32_t> steps = select_rotation_keys(rotation_steps(rotation_workload_, row_size), row_size, max_key_switches_);
+
+        // SEAL maps step 0 to the column rotation, which is complex conjugation in CKKS.
+        if (rotation_workload_.column_rotation)
+        {
+            steps.push_back(0);
+        }
+
+        return steps;
+    }
+
+    size_t FHEBuilder::galois_keys_size(const size_t poly_modulus_degree, const size_t coeff_modulus_count) const
+    {
+        // Without at least one data prime and the special prime there is no key switching and no keys.
+        if (!galois_keys_ || coeff_modulus_count < 2)
+        {
+            return 0;
+        }
+
+        size_t key_count = galois_key_steps(poly_modulus_degree).size();
+        if (key_count == 0 && !use_rotation_workload_)
+        {
+            // Every power-of-two step in both directions, plus the column rotation.
+            key_count = 2 * static_cast<size_t>(seal::util::get_power_of_two(poly_modulus_degree) - 1) + 1;
+        }
+
+        // Each key holds one size-2 ciphertext over all primes per data prime.
+        return key_count * (coeff_modulus_count - 1) * 2 * coeff_modulus_count * poly_modulus_degree * sizeof(uint64_t);
+    }
+
+    std::vector<int32_t> FHEBuilder::create_galois_keys(seal::KeyGenerator& key_generator, const size_t poly_modulus_degree, seal::GaloisKeys& destination) const
+    {
+        const std::vector<int32_t> steps = galois_key_steps(poly_modulus_degree);
+
+        if (!steps.empty())
+        {
+            key_generator.create_galois_keys(steps, destination);
+        }
+        else if (!use_rotation_workload_)
+        {
+            key_generator.create_galois_keys(destination);
+        }
+
+        return steps;
+    }
+
+    FHEBuilder& FHEBuilder::mod_switch_policy(const mod_switch_policy_t policy, const size_t coeff_modulus_size)
+    {
+        if (coeff_modulus_size < 1)
+        {
+            throw std::invalid_argument("The target coefficient modulus size must be at least 1.");
+        }
+
+        mod_switch_policy_ = policy;
+        mod_switch_level_ = coeff_modulus_size;
+        return *this;
+    }
+
+    FHEBuilder& FHEBuilder::thread_count(const size_t count)
+    {
+        thread_count_ = count;
+        return *this;
+    }
+
+    FHEBuilder& FHEBuilder::thread_local_memory_pools(const bool use)
+    {
+        thread_local_memory_pools_ = use;
         return *this;
     }
 
@@ -161,17 +262,8 @@ namespace fhe
         if (secret_key_)secret_key = key_generator.secret_key();
         if (public_key_) key_generator.create_public_key(public_key);
         if (relin_keys_) key_generator.create_relin_keys(relin_keys);
-        if (galois_keys_) 
-        {
-            if (rotatin_steps_.empty())
-            {
-                key_generator.create_galois_keys(galois_keys);
-            }
-            else 
-            {
-                key_generator.create_galois_keys(rotatin_steps_, galois_keys);
-            }
-        }
+        std::vector<int32_t> key_steps;
+        if (galois_keys_) key_steps = create_galois_keys(key_generator, poly_modulus_degree, galois_keys);
 
 
         try 
@@ -182,7 +274,7 @@ namespace fhe
             auto decryptor = std::make_unique<seal::Decryptor>(*context, secret_key);
             auto evaluator = std::make_unique<seal::Evaluator>(*context);
 
-            return *new FHE(
+            FHE& fhe = *new FHE(
                 scheme,
                 sec_level_,
                 std::move(context),
@@ -196,6 +288,13 @@ namespace fhe
                 relin_keys,
                 galois_keys
             );
+
+            fhe.mod_switch_policy() = mod_switch_policy_;
+            fhe.mod_switch_level() = mod_switch_level_;
+            fhe.route_rotations(key_steps);
+            fhe.thread_count(thread_count_);
+            fhe.thread_local_memory_pools() = thread_local_memory_pools_;
+            return fhe;
         }
         catch (const std::exception&) 
         {
@@ -301,17 +400,8 @@ namespace fhe
         if (secret_key_)secret_key = key_generator.secret_key();
         if (public_key_) key_generator.create_public_key(public_key);
         if (relin_keys_) key_generator.create_relin_keys(relin_keys);
-        if (galois_keys_) 
-        {
-            if (rotatin_steps_.empty()) 
-            {
-                key_generator.create_galois_keys(galois_keys);
-            }
-            else 
-            {
-                key_generator.create_galois_keys(rotatin_steps_, galois_keys);
-            }
-        }
+        std::vector<int32_t> key_steps;
+        if (galois_keys_) key_steps = create_galois_keys(key_generator, poly_modulus_degree, galois_keys);
    
         try 
         {
@@ -321,7 +411,7 @@ namespace fhe
             auto decryptor = std::make_unique<seal::Decryptor>(*context, secret_key);
             auto evaluator = std::make_unique<seal::Evaluator>(*context);
 
-            return *new FHE(
+            FHE& fhe = *new FHE(
                 scheme,
                 sec_level_,
                 std::move(context),
@@ -336,6 +426,11 @@ namespace fhe
                 relin_keys,
                 galois_keys
             );
+
+            fhe.route_rotations(key_steps);
+            fhe.thread_count(thread_count_);
+            fhe.thread_local_memory_pools() = thread_local_memory_pools_;
+            return fhe;
         }
         catch (const std::exception&)
         {
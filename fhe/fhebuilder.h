@@ -3,6 +3,7 @@
 #include "seal/seal.h"
 #include "fhe.h"
 #include "common.h"
+#include "rotation.h"
 #include <vector>
 
 namespace fhe
@@ -71,6 +72,67 @@ namespace fhe
         */
         FHEBuilder& galois_keys(const bool use, const std::vector<int32_t> rotatin_steps = {});
 
+        /**
+        Generate Galois keys only for the rotations of a declared workload.
+
+        @details
+        The workload is expanded into the exact steps its operations issue, and a small key set is chosen so that
+        each of those steps takes at most `max_key_switches` key switches. Steps without a key of their own are
+        routed through the keyed ones (see `FHE::route_rotations`). Use `galois_key_steps` and `galois_keys_size`
+        to inspect the result before building.
+
+        @param[in] workload The rotations the circuit performs.
+        @param[in] max_key_switches (Optional) Maximum number of key switches per rotation. Must be at least 1.
+        @return Reference to the current FHEBuilder instance.
+        */
+        FHEBuilder& galois_keys(const rotation_workload_t& workload, const size_t max_key_switches = 2);
+
+        /**
+        Get the rotation steps that Galois keys will be generated for.
+
+        @details
+        Step 0 stands for the column rotation (BGV/BFV) or complex conjugation (CKKS). An empty result means
+        that either every power-of-two step is used (no steps and no workload given) or no keys are needed.
+
+        @param[in] poly_modulus_degree The degree of the polynomial modulus.
+        @return The rotation steps.
+        */
+        std::vector<int32_t> galois_key_steps(const size_t poly_modulus_degree) const;
+
+        /**
+        Estimate the memory size of the Galois keys that will be generated.
+
+        @param[in] poly_modulus_degree The degree of the polynomial modulus.
+        @param[in] coeff_modulus_count The number of primes in the coefficient modulus, including the special prime.
+        @return The size in bytes.
+        */
+        size_t galois_keys_size(const size_t poly_modulus_degree, const size_t coeff_modulus_count) const;
+
+        /**
+        Set the modulus switching policy applied after BGV and BFV multiplication.
+
+        @param[in] policy The modulus switching policy (eager, never, noise budget, or fixed level).
+        @param[in] coeff_modulus_size (Optional) Target number of primes for the fixed level policy. Must be at least 1.
+        @return Reference to the current FHEBuilder instance.
+        */
+        FHEBuilder& mod_switch_policy(const mod_switch_policy_t policy, const size_t coeff_modulus_size = 1);
+
+        /**
+        Set the number of threads that parallel and batch operations of the built instance run on.
+
+        @param[in] count The number of threads, including the calling thread. If 0, the number of hardware threads is used.
+        @return Reference to the current FHEBuilder instance.
+        */
+        FHEBuilder& thread_count(const size_t count);
+
+        /**
+        Specify whether SEAL's temporary allocations come from per-thread memory pools (see `FHE::thread_local_memory_pools`).
+
+        @param[in] use Boolean flag to indicate usage of per-thread memory pools.
+        @return Reference to the current FHEBuilder instance.
+        */
+        FHEBuilder& thread_local_memory_pools(const bool use);
+
         /**
         Build an FHE instance for integer arithmetic.
 
@@ -133,6 +195,11 @@ namespace fhe
         ) const;
 
     private:
+        /**
+        Generate the configured Galois keys and return the steps they were generated for.
+        */
+        std::vector<int32_t> create_galois_keys(seal::KeyGenerator& key_generator, const size_t poly_modulus_degree, seal::GaloisKeys& destination) const;
+
         seal::sec_level_type sec_level_;
 
         mul_mode_t default_mul_mode_;
@@ -146,5 +213,19 @@ namespace fhe
         bool galois_keys_;
 
         std::vector<int32_t> rotatin_steps_;
+
+        bool use_rotation_workload_;
+
+        rotation_workload_t rotation_workload_;
+
+        size_t max_key_switches_;
+
+        mod_switch_policy_t mod_switch_policy_;
+
+        size_t mod_switch_level_;
+
+        size_t thread_count_;
+
+        bool thread_local_memory_pools_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "querybatcher.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe
+{
+    QueryBatcher::QueryBatcher(const FHE& fhe, const int32_t query_width, circuit_t circuit, const std::chrono::microseconds latency_window) :
+        fhe_(fhe),
+        query_width_(query_width),
+        lanes_(0),
+        circuit_(std::move(circuit)),
+        latency_window_(latency_window),
+        flush_count_(0),
+        stopping_(false) {
+
+        if (query_width < 1 || query_width > fhe_.row_size())
+        {
+            throw std::invalid_argument("The query width must be between 1 and the row size (inclusive).");
+        }
+
+        if (!circuit_)
+        {
+            throw std::invalid_argument("The circuit must not be empty.");
+        }
+
+        lanes_ = static_cast<size_t>(fhe_.row_size() / query_width);
+        dispatcher_ = std::thread(&QueryBatcher::dispatch_loop, this);
+    }
+
+    QueryBatcher::~QueryBatcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        condition_.notify_all();
+        dispatcher_.join();
+    }
+
+    std::future<seal::Ciphertext> QueryBatcher::submit(const seal::Ciphertext& query)
+    {
+        pending_query_t pending;
+        pending.query = query;
+        pending.arrival = std::chrono::steady_clock::now();
+        std::future<seal::Ciphertext> result = pending.result.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(std::move(pending));
+        }
+
+        condition_.notify_all();
+        return result;
+    }
+
+    void QueryBatcher::flush()
+    {
+        {
+            // Only the queries pending now are hurried; later ones still wait for their latency window.
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_count_ = pending_.size();
+        }
+
+        condition_.notify_all();
+    }
+
+    size_t QueryBatcher::lanes() const
+    {
+        return lanes_;
+    }
+
+    void QueryBatcher::dispatch_loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (true)
+        {
+            condition_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+
+            if (pending_.empty())
+            {
+                break;
+            }
+
+            // Wait for the batch to fill up, but no longer than the oldest query's latency window.
+            const auto deadline = pending_.front().arrival + latency_window_;
+            condition_.wait_until(lock, deadline, [this]
+            {
+                return stopping_ || flush_count_ > 0 || pending_.size() >= lanes_;
+            });
+
+            std::vector<pending_query_t> batch;
+            while (!pending_.empty() && batch.size() < lanes_)
+            {
+                batch.push_back(std::move(pending_.front()));
+                pending_.pop_front();
+            }
+
+            flush_count_ -= std::min(flush_count_, batch.size());
+
+            lock.unlock();
+            evaluate(batch);
+            lock.lock();
+        }
+    }
+
+    void QueryBatcher::evaluate(std::vector<pending_query_t>& batch) const
+    {
+        try
+        {
+            // Lane j starts at slot j * query_width; the queries are zero outside their lane, so adding places them.
+            seal::Ciphertext packed = batch[0].query;
+            seal::Ciphertext shifted(fhe_.memory_pool());
+
+            for (size_t j = 1; j < batch.size(); j++)
+            {
+                fhe_.rotate(batch[j].query, -static_cast<int32_t>(j) * query_width_, shifted);
+                fhe_.add_inplace(packed, shifted);
+            }
+
+            circuit_(fhe_, packed);
+
+            for (size_t j = 0; j < batch.size(); j++)
+            {
+                seal::Ciphertext result;
+                fhe_.rotate(packed, static_cast<int32_t>(j) * query_width_, result);
+                fhe_.mask_range_inplace(result, 0, query_width_);
+                batch[j].result.set_value(std::move(result));
+            }
+        }
+        catch (...)
+        {
+            // Every query of the batch shares the failure; results already delivered are left as they are.
+            for (pending_query_t& pending : batch)
+            {
+                try
+                {
+                    pending.result.set_exception(std::current_exception());
+                }
+                catch (const std::future_error&)
+                {
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "seal/seal.h"
+#include "fhe.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class QueryBatcher
+    A batching layer that evaluates one circuit for many independent queries at once.
+
+    @details
+    A query uses only its first `query_width` slots of each row (of the slot vector for CKKS), which must be
+    zero elsewhere, as when a vector of at most `query_width` values is encoded. Queries submitted within the
+    latency window are placed side by side in one ciphertext, in lanes of `query_width` slots. The circuit runs
+    once for the whole batch, and every query receives its own lane of the result, moved back to the front and
+    masked so that it holds no other query's slots. A batch is dispatched as soon as all lanes are taken or the
+    oldest query has waited for the latency window, so throughput grows with the number of lanes.
+
+    The circuit must keep every lane's results inside that lane: slot-wise operations are fine, and so are
+    rotations and reductions that stay within blocks of `query_width` slots (for example `row_sum` with a range
+    that divides `query_width`, read at the lane starts).
+
+    Packing costs one rotation per query and unpacking one rotation and one mask multiplication per query.
+    Batches are evaluated on a background thread; `submit` can be called from any thread.
+    */
+    class QueryBatcher
+    {
+    public:
+        /**
+        The circuit evaluated on each batch, in place.
+        */
+        using circuit_t = std::function<void(const FHE&, seal::Ciphertext&)>;
+
+        /**
+        Creates a batcher and starts its dispatch thread.
+
+        @param[in] fhe The FHE instance used to evaluate the batches. Must outlive the batcher.
+        @param[in] query_width The number of slots of each row used by a query.
+        @param[in] circuit The circuit evaluated on each batch.
+        @param[in] latency_window The longest time a query waits for others before its batch is dispatched.
+
+        @throws std::invalid_argument If `query_width` is outside the row size or `circuit` is empty.
+        */
+        QueryBatcher(const FHE& fhe, const int32_t query_width, circuit_t circuit, const std::chrono::microseconds latency_window);
+
+        /**
+        Dispatches the queries that are still pending and stops the dispatch thread.
+        */
+        ~QueryBatcher();
+
+        QueryBatcher(const QueryBatcher&) = delete;
+
+        QueryBatcher& operator=(const QueryBatcher&) = delete;
+
+        /**
+        Submits a query for evaluation.
+
+        @param[in] query The encrypted query, zero outside its first `query_width` slots of each row.
+        @return A future that receives the circuit's result for this query, in its first `query_width` slots.
+        Evaluation errors are reported through the future.
+        */
+        std::future<seal::Ciphertext> submit(const seal::Ciphertext& query);
+
+        /**
+        Dispatches the pending queries without waiting for the latency window.
+
+        @details
+        Queries submitted afterwards still wait for their own latency window. Without pending queries this does nothing.
+        */
+        void flush();
+
+        /**
+        Retrieves the number of queries that fit in one batch.
+
+        @return The number of lanes.
+        */
+        size_t lanes() const;
+
+    private:
+        struct pending_query_t
+        {
+            seal::Ciphertext query;
+
+            std::promise<seal::Ciphertext> result;
+
+            std::chrono::steady_clock::time_point arrival;
+        };
+
+        void dispatch_loop();
+
+        void evaluate(std::vector<pending_query_t>& batch) const;
+
+        const FHE& fhe_;
+
+        int32_t query_width_;
+
+        size_t lanes_;
+
+        circuit_t circuit_;
+
+        std::chrono::microseconds latency_window_;
+
+        std::mutex mutex_;
+
+        std::condition_variable condition_;
+
+        std::deque<pending_query_t> pending_;
+
+        size_t flush_count_;
+
+        bool stopping_;
+
+        std::thread dispatcher_;
+    };
+}
@@ -0,0 +1,460 @@
+#include "rotation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+
+namespace fhe
+{
+    namespace
+    {
+        // Number of rotations needed to add up the blocks of the given digits: one per doubling and one per extra digit.
+        size_t digit_rotation_count(const std::vector<int32_t>& digits)
+        {
+            const size_t nonzero = static_cast<size_t>(std::count_if(digits.begin(), digits.end(), [](int32_t d) { return d != 0; }));
+            return digits.size() - 1 + nonzero - 1;
+        }
+
+        // Marks every step reachable with at most `max_depth` key switches.
+        std::vector<uint8_t> reachable_steps(const std::vector<int32_t>& keys, const int32_t row_size, const size_t max_depth)
+        {
+            std::vector<uint8_t> reached(static_cast<size_t>(row_size), 0);
+            std::vector<int32_t> frontier = { 0 };
+            reached[0] = 1;
+
+            for (size_t depth = 0; depth < max_depth && !frontier.empty(); depth++)
+            {
+                std::vector<int32_t> next;
+                for (const int32_t from : frontier)
+                {
+                    for (const int32_t key : keys)
+                    {
+                        const int32_t to = ((from + key) % row_size + row_size) % row_size;
+                        if (!reached[to])
+                        {
+                            reached[to] = 1;
+                            next.push_back(to);
+                        }
+                    }
+                }
+                frontier = std::move(next);
+            }
+
+            return reached;
+        }
+
+        bool covers(const std::vector<int32_t>& keys, const std::vector<int32_t>& required, const int32_t row_size, const size_t max_depth)
+        {
+            const std::vector<uint8_t> reached = reachable_steps(keys, row_size, max_depth);
+            return std::all_of(required.begin(), required.end(), [&](int32_t step) { return reached[(step + row_size) % row_size] != 0; });
+        }
+    }
+
+    int32_t normalize_rotation_step(const int32_t step, const int32_t row_size)
+    {
+        int32_t normalized = ((step % row_size) + row_size) % row_size;
+
+        if (normalized > row_size / 2)
+        {
+            normalized -= row_size;
+        }
+
+        return normalized;
+    }
+
+    std::vector<int32_t> signed_binary_digits(const int32_t value)
+    {
+        if (value < 1)
+        {
+            throw std::invalid_argument("The value must be positive.");
+        }
+
+        std::vector<int32_t> binary;
+        std::vector<int32_t> naf;
+
+        for (int64_t rest = value; rest > 0; rest >>= 1)
+        {
+            binary.push_back(static_cast<int32_t>(rest & 1));
+        }
+
+        for (int64_t rest = value; rest > 0; rest >>= 1)
+        {
+            int32_t digit = 0;
+            if (rest & 1)
+            {
+                digit = 2 - static_cast<int32_t>(rest & 3);
+                rest -= digit;
+            }
+            naf.push_back(digit);
+        }
+
+        return digit_rotation_count(naf) < digit_rotation_count(binary) ? naf : binary;
+    }
+
+    std::vector<int32_t> sliding_sum_steps(const int32_t window_size, const int32_t stride, const int32_t row_size)
+    {
+        const std::vector<int32_t> digits = signed_binary_digits(window_size);
+        const size_t top = digits.size() - 1;
+        std::vector<int32_t> steps;
+
+        for (size_t k = 1; k <= top; k++)
+        {
+            steps.push_back(normalize_rotation_step(static_cast<int32_t>(stride * (int64_t(1) << (k - 1)) % row_size), row_size));
+        }
+
+        int64_t offset = int64_t(1) << top;
+        for (size_t k = top; k-- > 0;)
+        {
+            if (digits[k] > 0)
+            {
+                steps.push_back(normalize_rotation_step(static_cast<int32_t>(stride * offset % row_size), row_size));
+                offset += int64_t(1) << k;
+            }
+            else if (digits[k] < 0)
+            {
+                offset -= int64_t(1) << k;
+                steps.push_back(normalize_rotation_step(static_cast<int32_t>(stride * offset % row_size), row_size));
+            }
+        }
+
+        return steps;
+    }
+
+    std::vector<int32_t> prefix_sum_steps(const int32_t range_size, const int32_t row_size)
+    {
+        std::vector<int32_t> steps;
+
+        for (int32_t step = 1; step < range_size; step <<= 1)
+        {
+            steps.push_back(normalize_rotation_step(-step, row_size));
+        }
+
+        return steps;
+    }
+
+    int32_t matvec_dimension(const size_t rows, const size_t cols, const int32_t row_size)
+    {
+        // Blocks are padded to a power of 2 so that they tile a row; larger matrices are split into full-row blocks.
+        const size_t size = std::max(rows, cols);
+        size_t dimension = 1;
+
+        while (dimension < size && dimension < static_cast<size_t>(row_size))
+        {
+            dimension <<= 1;
+        }
+
+        return static_cast<int32_t>(dimension);
+    }
+
+    int32_t matvec_baby_steps(const int32_t dimension)
+    {
+        return static_cast<int32_t>(std::ceil(std::sqrt(static_cast<double>(dimension))));
+    }
+
+    std::vector<int32_t> matvec_rotation_steps(const size_t rows, const size_t cols, const int32_t row_size)
+    {
+        const int32_t dimension = matvec_dimension(rows, cols, row_size);
+        const int32_t baby_steps = matvec_baby_steps(dimension);
+        std::vector<int32_t> steps;
+
+        // Replicating the input vector across the row.
+        for (int32_t step = dimension; step < row_size; step <<= 1)
+        {
+            steps.push_back(normalize_rotation_step(-step, row_size));
+        }
+
+        // Baby steps rotate the input, giant steps rotate the partial sums.
+        for (int32_t step = 1; step < baby_steps && step < dimension; step++)
+        {
+            steps.push_back(normalize_rotation_step(step, row_size));
+        }
+
+        for (int32_t step = baby_steps; step < dimension; step += baby_steps)
+        {
+            steps.push_back(normalize_rotation_step(step, row_size));
+        }
+
+        return steps;
+    }
+
+    permutation_plan_t plan_permutation(const std::vector<int32_t>& source, const int32_t row_size)
+    {
+        if (source.size() > static_cast<size_t>(row_size))
+        {
+            throw std::invalid_argument("The permutation must not be longer than the row size.");
+        }
+
+        permutation_plan_t plan;
+
+        for (size_t slot = 0; slot < source.size(); slot++)
+        {
+            if (source[slot] < 0)
+            {
+                continue;
+            }
+
+            if (source[slot] >= row_size)
+            {
+                throw std::invalid_argument("The source slots must be less than the row size.");
+            }
+
+            plan.offsets.push_back(normalize_rotation_step(source[slot] - static_cast<int32_t>(slot), row_size));
+        }
+
+        std::sort(plan.offsets.begin(), plan.offsets.end());
+        plan.offsets.erase(std::unique(plan.offsets.begin(), plan.offsets.end()), plan.offsets.end());
+
+        if (plan.offsets.empty())
+        {
+            return plan;
+        }
+
+        // Offsets in an arithmetic progression (as in the matrix transforms) split evenly into baby and giant steps.
+        int32_t stride = 0;
+        plan.base = plan.offsets.front();
+
+        for (const int32_t offset : plan.offsets)
+        {
+            stride = std::gcd(stride, offset - plan.base);
+        }
+
+        plan.stride = std::max(stride, 1);
+        plan.baby_steps = matvec_baby_steps((plan.offsets.back() - plan.base) / plan.stride + 1);
+        return plan;
+    }
+
+    std::vector<int32_t> permutation_rotation_steps(const std::vector<int32_t>& source, const int32_t row_size)
+    {
+        const permutation_plan_t plan = plan_permutation(source, row_size);
+        std::vector<int32_t> steps;
+
+        for (const int32_t offset : plan.offsets)
+        {
+            const int32_t index = (offset - plan.base) / plan.stride;
+            const int64_t giant = plan.base + int64_t(plan.stride) * (index / plan.baby_steps) * plan.baby_steps;
+
+            steps.push_back(normalize_rotation_step(plan.stride * (index % plan.baby_steps), row_size));
+            steps.push_back(normalize_rotation_step(static_cast<int32_t>(giant % row_size), row_size));
+        }
+
+        return steps;
+    }
+
+    std::vector<int32_t> matrix_transform_source(const matrix_transform_t transform, const size_t dimension, const size_t shift)
+    {
+        std::vector<int32_t> source(dimension * dimension);
+
+        for (size_t i = 0; i < dimension; i++)
+        {
+            for (size_t j = 0; j < dimension; j++)
+            {
+                size_t row = i;
+                size_t col = j;
+
+                switch (transform)
+                {
+                case matrix_transform_t::sigma:
+                    col = (i + j) % dimension;
+                    break;
+                case matrix_transform_t::tau:
+                    row = (i + j) % dimension;
+                    break;
+                case matrix_transform_t::column_shift:
+                    col = (j + shift) % dimension;
+                    break;
+                case matrix_transform_t::row_shift:
+                    row = (i + shift) % dimension;
+                    break;
+                }
+
+                source[i * dimension + j] = static_cast<int32_t>(row * dimension + col);
+            }
+        }
+
+        return source;
+    }
+
+    std::vector<int32_t> matmul_rotation_steps(const size_t dimension, const int32_t row_size)
+    {
+        const int64_t area = static_cast<int64_t>(dimension * dimension);
+        std::vector<int32_t> steps;
+        const auto append = [&steps](const std::vector<int32_t>& more)
+        {
+            steps.insert(steps.end(), more.begin(), more.end());
+        };
+
+        if (dimension < 1 || area > row_size)
+        {
+            throw std::invalid_argument("The matrix must be non-empty and fit in one row.");
+        }
+
+        append(permutation_rotation_steps(matrix_transform_source(matrix_transform_t::sigma, dimension), row_size));
+        append(permutation_rotation_steps(matrix_transform_source(matrix_transform_t::tau, dimension), row_size));
+
+        // Row shifts are plain rotations when the matrix fills the row or is repeated once behind itself.
+        if (2 * area <= row_size)
+        {
+            steps.push_back(normalize_rotation_step(static_cast<int32_t>(-area), row_size));
+        }
+
+        for (size_t k = 1; k < dimension; k++)
+        {
+            append(permutation_rotation_steps(matrix_transform_source(matrix_transform_t::column_shift, dimension, k), row_size));
+
+            if (area == row_size || 2 * area <= row_size)
+            {
+                steps.push_back(normalize_rotation_step(static_cast<int32_t>(k * dimension), row_size));
+            }
+            else
+            {
+                append(permutation_rotation_steps(matrix_transform_source(matrix_transform_t::row_shift, dimension, k), row_size));
+            }
+        }
+
+        return steps;
+    }
+
+    std::vector<int32_t> rotation_steps(const rotation_workload_t& workload, const int32_t row_size)
+    {
+        std::vector<int32_t> steps;
+        const auto append = [&steps](const std::vector<int32_t>& more)
+        {
+            steps.insert(steps.end(), more.begin(), more.end());
+        };
+
+        for (const int32_t step : workload.rotation_steps)
+        {
+            steps.push_back(normalize_rotation_step(step, row_size));
+        }
+
+        for (const int32_t range_size : workload.range_sums)
+        {
+            append(sliding_sum_steps(range_size, 1, row_size));
+        }
+
+        for (const int32_t window_size : workload.window_sums)
+        {
+            append(sliding_sum_steps(window_size, -1, row_size));
+        }
+
+        for (const int32_t range_size : workload.prefix_sums)
+        {
+            append(prefix_sum_steps(range_size, row_size));
+        }
+
+        for (const auto& range : workload.extractions)
+        {
+            steps.push_back(normalize_rotation_step(range.first, row_size));
+            if (range.second > 0 && row_size / range.second > 1)
+            {
+                append(sliding_sum_steps(row_size / range.second, -range.second, row_size));
+            }
+        }
+
+        for (const int32_t stride : workload.pack_strides)
+        {
+            for (int32_t shift = 1; shift < stride; shift++)
+            {
+                steps.push_back(normalize_rotation_step(-shift, row_size));
+                steps.push_back(normalize_rotation_step(shift, row_size));
+            }
+        }
+
+        if (workload.broadcast)
+        {
+            append(sliding_sum_steps(row_size, 1, row_size));
+        }
+
+        for (const auto& dims : workload.matrix_dims)
+        {
+            append(matvec_rotation_steps(dims.first, dims.second, row_size));
+        }
+
+        for (const std::vector<int32_t>& source : workload.permutations)
+        {
+            append(permutation_rotation_steps(source, row_size));
+        }
+
+        for (const size_t dimension : workload.matrix_products)
+        {
+            append(matmul_rotation_steps(dimension, row_size));
+        }
+
+        steps.erase(std::remove(steps.begin(), steps.end(), 0), steps.end());
+        std::sort(steps.begin(), steps.end());
+        steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+        return steps;
+    }
+
+    std::vector<int32_t> select_rotation_keys(const std::vector<int32_t>& required, const int32_t row_size, const size_t max_key_switches)
+    {
+        if (max_key_switches < 1)
+        {
+            throw std::invalid_argument("The number of key switches per rotation must be at least 1.");
+        }
+
+        std::vector<int32_t> targets = required;
+        std::sort(targets.begin(), targets.end(), [](int32_t a, int32_t b)
+        {
+            return std::abs(a) != std::abs(b) ? std::abs(a) < std::abs(b) : a > b;
+        });
+
+        // Shortest steps first, so that longer ones can be composed from them.
+        std::vector<int32_t> keys;
+        std::vector<uint8_t> reached = reachable_steps(keys, row_size, max_key_switches);
+
+        for (const int32_t step : targets)
+        {
+            if (!reached[(step + row_size) % row_size])
+            {
+                keys.push_back(step);
+                reached = reachable_steps(keys, row_size, max_key_switches);
+            }
+        }
+
+        // Drop keys that the others already make redundant, longest first.
+        for (size_t i = keys.size(); i-- > 0;)
+        {
+            std::vector<int32_t> fewer = keys;
+            fewer.erase(fewer.begin() + i);
+
+            if (covers(fewer, targets, row_size, max_key_switches))
+            {
+                keys = std::move(fewer);
+            }
+        }
+
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    std::vector<int32_t> rotation_route_table(const std::vector<int32_t>& keys, const int32_t row_size)
+    {
+        std::vector<int32_t> last_key(static_cast<size_t>(row_size), 0);
+        std::vector<uint8_t> reached(static_cast<size_t>(row_size), 0);
+        std::vector<int32_t> frontier = { 0 };
+        reached[0] = 1;
+
+        while (!frontier.empty())
+        {
+            std::vector<int32_t> next;
+            for (const int32_t from : frontier)
+            {
+                for (const int32_t key : keys)
+                {
+                    const int32_t to = ((from + key) % row_size + row_size) % row_size;
+                    if (!reached[to])
+                    {
+                        reached[to] = 1;
+                        last_key[to] = key;
+                        next.push_back(to);
+                    }
+                }
+            }
+            frontier = std::move(next);
+        }
+
+        return last_key;
+    }
+}
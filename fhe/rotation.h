@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @struct rotation_workload_t
+    Describes the rotations a circuit performs, so that only the Galois keys it needs are generated.
+
+    @details
+    Every entry is expanded into the exact rotation steps that the matching FHE operation issues.
+    Sizes are in slots of a BGV/BFV row or of the CKKS slot vector.
+    */
+    struct rotation_workload_t
+    {
+        /**
+        Steps passed directly to `rotate_rows`, `rotate_vector` or `rotate_many`.
+        */
+        std::vector<int32_t> rotation_steps;
+
+        /**
+        Range sizes passed to `row_sum` or `slot_sum`.
+        */
+        std::vector<int32_t> range_sums;
+
+        /**
+        Window sizes passed to `window_sum`.
+        */
+        std::vector<int32_t> window_sums;
+
+        /**
+        Range sizes passed to `prefix_sum`.
+        */
+        std::vector<int32_t> prefix_sums;
+
+        /**
+        Ranges (first slot, size) passed to `extract`; `replicate(block_size)` is the range (0, block_size).
+        */
+        std::vector<std::pair<int32_t, int32_t>> extractions;
+
+        /**
+        Strides passed to `pack` and `unpack`.
+        */
+        std::vector<int32_t> pack_strides;
+
+        /**
+        Whether `broadcast_slot` is used. For BGV/BFV it also needs `column_rotation`.
+        */
+        bool broadcast = false;
+
+        /**
+        Matrix dimensions (rows, columns) passed to `matvec`.
+        */
+        std::vector<std::pair<size_t, size_t>> matrix_dims;
+
+        /**
+        Slot permutations passed to `permute` or `permute_many`.
+        */
+        std::vector<std::vector<int32_t>> permutations;
+
+        /**
+        Dimensions of the square matrices multiplied by `EncryptedMatrix::multiply`.
+        */
+        std::vector<size_t> matrix_products;
+
+        /**
+        Whether `rotate_columns`/`column_sum` (BGV/BFV) or `complex_conjugate` (CKKS) is used.
+        */
+        bool column_rotation = false;
+    };
+
+    /**
+    @struct permutation_plan_t
+    The baby-step giant-step schedule of a slot permutation, as evaluated by `FHE::permute`.
+
+    @details
+    Slot `i` of the result receives slot `i + offset` of the input, and the distinct offsets are written as
+    `base + stride * (giant * baby_steps + baby)`. Each baby step rotates the input and each giant step rotates
+    a sum of masked baby rotations.
+    */
+    struct permutation_plan_t
+    {
+        /**
+        The distinct normalized offsets, in ascending order.
+        */
+        std::vector<int32_t> offsets;
+
+        /**
+        The smallest offset.
+        */
+        int32_t base = 0;
+
+        /**
+        The greatest common divisor of the differences between the offsets.
+        */
+        int32_t stride = 1;
+
+        /**
+        The number of baby steps.
+        */
+        int32_t baby_steps = 1;
+    };
+
+    /**
+    Enumeration of the slot permutations of a row-major d x d matrix used by `EncryptedMatrix::multiply`.
+    */
+    enum class matrix_transform_t : std::uint8_t
+    {
+        // Entry (i, j) receives entry (i, i + j).
+        sigma = 0x1,
+
+        // Entry (i, j) receives entry (i + j, j).
+        tau = 0x2,
+
+        // Entry (i, j) receives entry (i, j + shift).
+        column_shift = 0x3,
+
+        // Entry (i, j) receives entry (i + shift, j).
+        row_shift = 0x4
+    };
+
+    /**
+    Reduces a rotation step to the range (-row_size/2, row_size/2], where 0 means no rotation.
+    */
+    int32_t normalize_rotation_step(const int32_t step, const int32_t row_size);
+
+    /**
+    Writes a positive value as signed binary digits (least significant first), choosing between the binary and
+    the non-adjacent form whichever needs fewer rotations when the digits are used as block sums.
+    */
+    std::vector<int32_t> signed_binary_digits(const int32_t value);
+
+    /**
+    Returns the rotation steps issued by a sliding sum over `window_size` slots that are `stride` apart.
+    */
+    std::vector<int32_t> sliding_sum_steps(const int32_t window_size, const int32_t stride, const int32_t row_size);
+
+    /**
+    Returns the rotation steps issued by a prefix sum over `range_size` slots.
+    */
+    std::vector<int32_t> prefix_sum_steps(const int32_t range_size, const int32_t row_size);
+
+    /**
+    Returns the side of the square block that a rows x columns matrix is padded to by `matvec`.
+    */
+    int32_t matvec_dimension(const size_t rows, const size_t cols, const int32_t row_size);
+
+    /**
+    Returns the number of baby steps used by `matvec` for a block of the given dimension.
+    */
+    int32_t matvec_baby_steps(const int32_t dimension);
+
+    /**
+    Returns the rotation steps issued by `matvec` for a rows x columns matrix.
+    */
+    std::vector<int32_t> matvec_rotation_steps(const size_t rows, const size_t cols, const int32_t row_size);
+
+    /**
+    Plans a slot permutation where slot `i` receives slot `source[i]` of the same row, or zero if it is negative.
+
+    @throws std::invalid_argument If `source` is longer than the row or refers to a slot outside it.
+    */
+    permutation_plan_t plan_permutation(const std::vector<int32_t>& source, const int32_t row_size);
+
+    /**
+    Returns the rotation steps issued by `permute` for a slot permutation.
+    */
+    std::vector<int32_t> permutation_rotation_steps(const std::vector<int32_t>& source, const int32_t row_size);
+
+    /**
+    Returns the slot permutation of a row-major d x d matrix (indices taken modulo d).
+    */
+    std::vector<int32_t> matrix_transform_source(const matrix_transform_t transform, const size_t dimension, const size_t shift = 0);
+
+    /**
+    Returns the rotation steps issued by `EncryptedMatrix::multiply` for d x d matrices.
+
+    @throws std::invalid_argument If the matrix is empty or has more than `row_size` entries.
+    */
+    std::vector<int32_t> matmul_rotation_steps(const size_t dimension, const int32_t row_size);
+
+    /**
+    Expands a workload into the distinct, normalized, nonzero rotation steps it issues.
+    */
+    std::vector<int32_t> rotation_steps(const rotation_workload_t& workload, const int32_t row_size);
+
+    /**
+    Selects a small set of key steps such that every required step is the sum of at most `max_key_switches` of them.
+
+    @details
+    Steps are visited from the shortest; a step becomes a key only if it cannot already be reached, and keys that
+    turn out to be redundant are pruned afterwards from the longest, so no key in the result can be dropped.
+    */
+    std::vector<int32_t> select_rotation_keys(const std::vector<int32_t>& required, const int32_t row_size, const size_t max_key_switches);
+
+    /**
+    Computes shortest rotation routes over a set of key steps.
+
+    @details
+    The result has one entry per normalized step (indexed by step modulo `row_size`) that holds the last key step
+    on a shortest route to it, or 0 if the step cannot be reached with these keys.
+    */
+    std::vector<int32_t> rotation_route_table(const std::vector<int32_t>& keys, const int32_t row_size);
+}
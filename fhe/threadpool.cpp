@@ -0,0 +1,124 @@
+#include "threadpool.h"
+#include <algorithm>
+
+namespace fhe
+{
+    ThreadPool::ThreadPool(const size_t thread_count) :
+        thread_count_(thread_count > 0 ? thread_count : std::max<size_t>(1, std::thread::hardware_concurrency())),
+        stopping_(false) {
+
+        // The calling thread of each loop is the remaining thread.
+        workers_.reserve(thread_count_ - 1);
+        for (size_t t = 1; t < thread_count_; t++)
+        {
+            workers_.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        condition_.notify_all();
+        for (std::thread& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::thread_count() const
+    {
+        return thread_count_;
+    }
+
+    void ThreadPool::parallel_for(const size_t count, const std::function<void(size_t)>& task)
+    {
+        if (workers_.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        auto loop = std::make_shared<loop_t>();
+        loop->task = &task;
+        loop->count = count;
+
+        // One entry per helping worker; entries taken after the loop has finished return immediately.
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t h = std::min(count - 1, workers_.size()); h > 0; h--)
+            {
+                loops_.push_back(loop);
+            }
+        }
+
+        condition_.notify_all();
+        run_loop(*loop);
+
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->done.wait(lock, [&loop] { return loop->completed == loop->count; });
+
+        if (loop->exception)
+        {
+            std::rethrow_exception(loop->exception);
+        }
+    }
+
+    void ThreadPool::run_loop(loop_t& loop)
+    {
+        // The task is only touched for unclaimed iterations, while the caller is still waiting.
+        for (size_t i = loop.next++; i < loop.count; i = loop.next++)
+        {
+            std::exception_ptr exception = nullptr;
+
+            try
+            {
+                (*loop.task)(i);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            if (exception && !loop.exception)
+            {
+                loop.exception = exception;
+            }
+
+            if (++loop.completed == loop.count)
+            {
+                loop.done.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::worker_loop()
+    {
+        while (true)
+        {
+            std::shared_ptr<loop_t> loop;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return stopping_ || !loops_.empty(); });
+
+                if (loops_.empty())
+                {
+                    return;
+                }
+
+                loop = std::move(loops_.front());
+                loops_.pop_front();
+            }
+
+            run_loop(*loop);
+        }
+    }
+}
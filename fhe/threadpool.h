@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fhe
+{
+    /**
+    @class ThreadPool
+    A fixed set of worker threads that run parallel loops.
+
+    @details
+    The thread calling `parallel_for` works on its own loop alongside the workers, so a loop started from inside
+    another loop's task makes progress even when every worker is busy, and nested loops cannot deadlock.
+    */
+    class ThreadPool
+    {
+    public:
+        /**
+        Creates a pool and starts its worker threads.
+
+        @param[in] thread_count The number of threads a loop runs on, including the calling thread.
+        If 0, the number of hardware threads is used.
+        */
+        explicit ThreadPool(const size_t thread_count);
+
+        /**
+        Stops and joins the worker threads. Loops must not be running.
+        */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+        Retrieves the number of threads a loop runs on, including the calling thread.
+        */
+        size_t thread_count() const;
+
+        /**
+        Runs `task(i)` for every i in [0, count) and returns when all of them are done.
+        Can be called from any thread, including from inside a task.
+
+        @param[in] count The number of iterations.
+        @param[in] task The loop body.
+
+        @throws The first exception thrown by a task, after the other iterations have finished.
+        */
+        void parallel_for(const size_t count, const std::function<void(size_t)>& task);
+
+    private:
+        struct loop_t
+        {
+            const std::function<void(size_t)>* task = nullptr;
+
+            size_t count = 0;
+
+            std::atomic<size_t> next{ 0 };
+
+            size_t completed = 0;
+
+            std::exception_ptr exception = nullptr;
+
+            std::mutex mutex;
+
+            std::condition_variable done;
+        };
+
+        static void run_loop(loop_t& loop);
+
+        void worker_loop();
+
+        size_t thread_count_;
+
+        std::vector<std::thread> workers_;
+
+        std::mutex mutex_;
+
+        std::condition_variable condition_;
+
+        std::deque<std::shared_ptr<loop_t>> loops_;
+
+        bool stopping_;
+    };
+}